@@ -10,21 +10,201 @@
 
 #include "Convoluter.h"
 
+#if JUCE_INTEL
+ #include <immintrin.h>
+ #if JUCE_MSVC
+  #include <intrin.h>
+ #else
+  #include <cpuid.h>
+ #endif
+#elif JUCE_ARM && (defined(__aarch64__) || defined(_M_ARM64))
+ #include <arm_neon.h>
+ #define SOUNDSTAGE_NEON 1
+#endif
+
+//IEEE half precision, rounded to nearest even
+static uint16_t float_to_half(float value) {
+	uint32_t bits;
+	std::memcpy(&bits, &value, sizeof(float));
+
+	uint32_t sign = (bits >> 16) & 0x8000;
+	int exponent = (int)((bits >> 23) & 0xff) - 127 + 15;
+	uint32_t mantissa = bits & 0x7fffff;
+
+	if (((bits >> 23) & 0xff) == 0xff)
+		return (uint16_t)(sign | 0x7c00 | (mantissa != 0 ? 0x200 : 0));
+
+	if (exponent >= 31)
+		return (uint16_t)(sign | 0x7c00);
+
+	if (exponent <= 0) {
+		if (exponent < -10)
+			return (uint16_t)sign;
+
+		mantissa |= 0x800000;
+		int shift = 14 - exponent;
+		uint32_t half = mantissa >> shift;
+		uint32_t remainder = mantissa & ((1u << shift) - 1);
+		uint32_t halfway = 1u << (shift - 1);
+
+		if (remainder > halfway || (remainder == halfway && (half & 1)))
+			half++;
+
+		return (uint16_t)(sign | half);
+	}
+
+	//a carry out of the mantissa correctly bumps the exponent
+	uint32_t half = sign | ((uint32_t)exponent << 10) | (mantissa >> 13);
+	uint32_t remainder = mantissa & 0x1fff;
+
+	if (remainder > 0x1000 || (remainder == 0x1000 && (half & 1)))
+		half++;
+
+	return (uint16_t)half;
+}
+
+static float half_to_float(uint16_t half) {
+	uint32_t sign = (uint32_t)(half & 0x8000) << 16;
+	uint32_t exponent = (half >> 10) & 0x1f;
+	uint32_t mantissa = half & 0x3ff;
+	uint32_t bits;
+
+	if (exponent == 0) {
+		float value = mantissa * (1.0f / 16777216.0f);
+		return sign != 0 ? -value : value;
+	}
+
+	if (exponent == 31)
+		bits = sign | 0x7f800000 | (mantissa << 13);
+	else
+		bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+
+	float value;
+	std::memcpy(&value, &bits, sizeof(float));
+	return value;
+}
+
+#if JUCE_INTEL
+/*
+* F16C is not part of the x64 baseline, so the build does not enable it and the
+* vector conversion is compiled for it on its own and picked at run time
+*/
+#if JUCE_MSVC
+ #define SOUNDSTAGE_TARGET_F16C
+#else
+ #define SOUNDSTAGE_TARGET_F16C __attribute__((target("avx,f16c")))
+#endif
+
+static bool cpu_has_f16c() {
+	int info[4];
+
+#if JUCE_MSVC
+	__cpuid(info, 1);
+#else
+	__cpuid(1, info[0], info[1], info[2], info[3]);
+#endif
+
+	bool osSavesAvx = (info[2] & (1 << 27)) != 0;
+	bool hasAvx = (info[2] & (1 << 28)) != 0;
+	bool hasF16C = (info[2] & (1 << 29)) != 0;
+
+	if (!osSavesAvx || !hasAvx || !hasF16C)
+		return false;
+
+	//the conversion is VEX encoded, so the OS also has to be saving the AVX registers
+#if JUCE_MSVC
+	unsigned long long enabled = _xgetbv(0);
+#else
+	unsigned int low, high;
+	__asm__ volatile ("xgetbv" : "=a"(low), "=d"(high) : "c"(0));
+	unsigned long long enabled = ((unsigned long long)high << 32) | low;
+#endif
+
+	return (enabled & 6) == 6;
+}
+
+static const bool useF16C = cpu_has_f16c();
+
+SOUNDSTAGE_TARGET_F16C static int widen_half_f16c(const uint16_t* source, float* dest, int num) {
+	int i = 0;
+
+	for (; i + 8 <= num; i += 8)
+		_mm256_storeu_ps(dest + i, _mm256_cvtph_ps(_mm_loadu_si128((const __m128i*)(source + i))));
+
+	return i;
+}
+#endif
+
+static void widen_half(const uint16_t* source, float* dest, int num) {
+	int i = 0;
+
+#if JUCE_INTEL
+	if (useF16C)
+		i = widen_half_f16c(source, dest, num);
+#elif SOUNDSTAGE_NEON
+	//every 64 bit ARM core converts half precision natively
+	for (; i + 4 <= num; i += 4)
+		vst1q_f32(dest + i, vcvt_f32_f16(vreinterpret_f16_u16(vld1_u16(source + i))));
+#endif
+
+	for (; i < num; i++)
+		dest[i] = half_to_float(source[i]);
+}
+
+static void widen_int16(const int16_t* source, float scale, float* dest, int num) {
+	int i = 0;
+
+#if JUCE_INTEL
+	__m128 gain = _mm_set1_ps(scale);
+
+	for (; i + 8 <= num; i += 8) {
+		__m128i packed = _mm_loadu_si128((const __m128i*)(source + i));
+		__m128i low = _mm_srai_epi32(_mm_unpacklo_epi16(packed, packed), 16);
+		__m128i high = _mm_srai_epi32(_mm_unpackhi_epi16(packed, packed), 16);
+
+		_mm_storeu_ps(dest + i, _mm_mul_ps(_mm_cvtepi32_ps(low), gain));
+		_mm_storeu_ps(dest + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(high), gain));
+	}
+#elif SOUNDSTAGE_NEON
+	for (; i + 8 <= num; i += 8) {
+		int16x8_t packed = vld1q_s16(source + i);
+
+		vst1q_f32(dest + i, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(packed))), scale));
+		vst1q_f32(dest + i + 4, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(packed))), scale));
+	}
+#endif
+
+	for (; i < num; i++)
+		dest[i] = scale * source[i];
+}
+
 Convoluter::Convoluter() {
 	currSamplesPerBlock = -1;
+	currSampleRate = 44100.0;
 	bufferSize = -1;
 	inputBuffer = juce::AudioBuffer<float>();
 	outputBuffer = juce::AudioBuffer<float>();
 	convolutedSignal = juce::AudioBuffer<float>();;
 	overflowStorage = juce::AudioBuffer<float>(2, 200);
 
-	inputPos = 0;
-	outputPos = 0;
+	outputSamples = 0;
 	elevation = 0;
 	azimuth = 0;
 
+	lowPriority = false;
+	lodThreshold = 0.0f;
+	lodActive = false;
+	chunkPeak = 0.0f;
+	overflowPeak = 0.0f;
+	silentSamples = 0;
+	bypassed = false;
+	lowDetail = false;
+	storage = HrirStorage::floatingPoint;
+	storageErrorDb = -std::numeric_limits<float>::infinity();
+
 	load_hrir_l();
 	load_hrir_r();
+	find_onsets();
 }
 
 Convoluter::~Convoluter() {
@@ -33,96 +213,154 @@ Convoluter::~Convoluter() {
 
 void Convoluter::setSamplesPerBlock(int samplesPerBlock) {
 
+	//the largest block readInput will be handed, each one is convoluted as it arrives
 	if (samplesPerBlock != currSamplesPerBlock) {
-		bufferSize = samplesPerBlock * 10;
+		bufferSize = samplesPerBlock;
 		inputBuffer = juce::AudioBuffer<float>(2, bufferSize);
 		outputBuffer = juce::AudioBuffer<float>(2, bufferSize);
 		convolutedSignal = juce::AudioBuffer<float>(2, bufferSize + 200);;
 		overflowStorage = juce::AudioBuffer<float>(2, 200);
+		currSamplesPerBlock = samplesPerBlock;
 	}
+
+	room.prepare(currSampleRate, bufferSize);
+	reset();
+}
+
+void Convoluter::reset() {
+	inputBuffer.clear();
+	outputBuffer.clear();
+	convolutedSignal.clear();
+	overflowStorage.clear();
+
+	outputSamples = 0;
+	chunkPeak = 0.0f;
+	overflowPeak = 0.0f;
+	silentSamples = 0;
+	lodActive = false;
+	bypassed = false;
+}
+
+int Convoluter::getLatencySamples() const {
+	//every block comes out of applyOutput straight after readInput, nothing is held back
+	return 0;
+}
+
+void Convoluter::setSampleRate(double sampleRate) {
+	currSampleRate = sampleRate;
 }
 
 void Convoluter::readInput(juce::AudioBuffer<float>& buffer) {
 	auto numInputChannels = buffer.getNumChannels();
+	int numSamples = buffer.getNumSamples();
+
+	jassert(numSamples <= bufferSize);
+	chunkPeak = 0.0f;
 
-	//for each channel add the current block to the input buffer
+	//for each channel copy the current block to the input buffer
 	for (int channel = 0; channel < numInputChannels; channel++) {
-		auto* writePointer = inputBuffer.getWritePointer(channel, inputPos);
+		auto* writePointer = inputBuffer.getWritePointer(channel);
 		auto* readPointer = buffer.getReadPointer(channel, 0);
 
-		for (int i = 0; i < buffer.getNumSamples(); i++) {
+		for (int i = 0; i < numSamples; i++) {
 			writePointer[i] = readPointer[i];
 		}
 
+		chunkPeak = juce::jmax(chunkPeak, buffer.getMagnitude(channel, 0, numSamples));
 	}
 
-	inputPos += buffer.getNumSamples();
+	//convolute straight away with the direction as it is now, so a head turn is heard in this block
+	convolute(numSamples);
+	outputSamples = numSamples;
+}
+
+void Convoluter::convolute(int numSamples) {
+
+	int i, j;
+	bool inputSilent = chunkPeak <= silenceThreshold;
+	bool tailSilent = overflowPeak <= silenceThreshold;
+
+	//activity tracker, counts how long the input has been silent including this block
+	silentSamples = inputSilent ? juce::jmin(silentSamples + numSamples, 1 << 30) : 0;
+
+	//the room has already rung out on silent input once it has seen its full tail,
+	//and keeps running for the block it takes to fade out after it is switched off
+	bool roomActive = room.isRunning() && silentSamples - numSamples < room.getTailLength();
 
-	//if the input buffer is full, convolute the signal and reset the input buffer
-	if (inputPos + 1 >= bufferSize) {
-		convolute();
-		inputPos = 0;
-		inputBuffer.clear();
+	bypassed = inputSilent && tailSilent && !roomActive;
+	if (bypassed) {
+		outputBuffer.clear();
+		overflowStorage.clear();
+		overflowPeak = 0.0f;
+		return;
 	}
 
-}
+	//quiet or low priority sources only run the part of each HRIR around its onset
+	if (chunkPeak < lodThreshold)
+		lodActive = true;
+	else if (chunkPeak > 2.0f * lodThreshold)
+		lodActive = false;
 
-void Convoluter::convolute() {
+	lowDetail = lowPriority || lodActive;
 
-	int num_conv = bufferSize + overflowSize ;
-	int i, j, k;
-	float temp;
+	int azIndex, elIndex;
+	closest_hrir_indices(azimuth, elevation, azIndex, elIndex);
 
 	/*
-	* for each channel, convolute the signal based on the current azimuth and elevation
+	* for each channel, convolute the signal with the HRIR for the current direction
 	* and add the samples from the overflow storage to the begining of the covoluted signal
 	*/
 	for (int channel = 0; channel < convolutedSignal.getNumChannels(); channel++) {
 		auto* writePointer = convolutedSignal.getWritePointer(channel);
 		auto* readPointer = inputBuffer.getReadPointer(channel);
-		float* hrtf;
+		const float* hrtf;
+		int firstTap = 0;
+		int lastTap = 200;
 
 		if (channel == 0) {
-			hrtf =
-				get_hrir_l(
-					closest_azimuth_index(correctAzimuth(azimuth)),
-					closest_elevation_index(correctElevation(elevation, azimuth))
-				);
+			hrtf = get_hrir_l(azIndex, elIndex);
 		}
-		else if (channel == 1) {
-			hrtf =
-				get_hrir_r(
-					closest_azimuth_index(correctAzimuth(azimuth)),
-					closest_elevation_index(correctElevation(elevation, azimuth))
-				);
+		else {
+			hrtf = get_hrir_r(azIndex, elIndex);
 		}
 
-		for (i = 0; i < num_conv; i++) {
-			k = i;
-			temp = 0.0;
-
-			//for each sample in filter
-			for (j = 0; j < 200; j++) {
-
-				if (k >= 0 && k < bufferSize) {
-					temp = temp + (readPointer[k] * hrtf[j]);
-				}
-
-				k--;
-				writePointer[i] = temp;
+		if (lowDetail) {
+			firstTap = channel == 0 ? hrir_onset_l[azIndex][elIndex] : hrir_onset_r[azIndex][elIndex];
+			lastTap = juce::jmin(200, firstTap + lodHrirLength);
+		}
 
+		//add each input sample's response
+		for (i = 0; i < (inputSilent ? 0 : numSamples); i++) {
+			float sample = readPointer[i];
+			float* out = writePointer + i;
 
+			for (j = firstTap; j < lastTap; j++) {
+				out[j] += sample * hrtf[j];
 			}
 		}
 
 		//add the overflow storage to the begining of the convoluted signal
-		auto* overflowPointer = overflowStorage.getReadPointer(channel);
-		for (int z = 0; z < 200; z++) {
-			writePointer[z] += overflowPointer[z];
+		if (!tailSilent) {
+			auto* overflowPointer = overflowStorage.getReadPointer(channel);
+			for (int z = 0; z < 200; z++) {
+				writePointer[z] += overflowPointer[z];
+			}
 		}
 	}
 
+	//early reflections and late reverb only ever land inside the current block
+	if (roomActive) {
+		room.setSourceDirection(azimuth, elevation, *this);
+		room.process(
+			inputBuffer.getReadPointer(0),
+			convolutedSignal.getWritePointer(0),
+			convolutedSignal.getWritePointer(1),
+			numSamples
+		);
+	}
+
 	overflowStorage.clear();
+	overflowPeak = 0.0f;
 
 	/*
 	* push convoluted signal to the output buffer
@@ -130,39 +368,71 @@ void Convoluter::convolute() {
 	*/ 
 	for (int channel = 0; channel < convolutedSignal.getNumChannels(); channel++) {
 		auto* readPointer = convolutedSignal.getReadPointer(channel);
-		auto* readPointerOverflow = convolutedSignal.getReadPointer(channel, bufferSize + 1);
+		auto* readPointerOverflow = convolutedSignal.getReadPointer(channel, numSamples);
 
-		outputBuffer.copyFrom(channel, 0, readPointer, bufferSize);
+		outputBuffer.copyFrom(channel, 0, readPointer, numSamples);
 		overflowStorage.copyFrom(channel, 0, readPointerOverflow, overflowSize);
+		overflowPeak = juce::jmax(overflowPeak, overflowStorage.getMagnitude(channel, 0, overflowSize));
+		convolutedSignal.clear(channel, 0, numSamples + overflowSize);
 	}
+}
 
-	convolutedSignal.clear();
+/*
+* the original single filter time domain loop, kept as the reference model that
+* every faster engine is checked against. output needs numSamples + 200 samples
+*/
+void Convoluter::reference_convolute(const float* input, int numSamples, const float* hrtf, float* output) {
+	int num_conv = numSamples + 200;
+	int i, j, k;
+	float temp;
+
+	for (i = 0; i < num_conv; i++) {
+		k = i;
+		temp = 0.0;
+
+		//for each sample in filter
+		for (j = 0; j < 200; j++) {
+
+			if (k >= 0 && k < numSamples) {
+				temp = temp + (input[k] * hrtf[j]);
+			}
+
+			k--;
+		}
+
+		output[i] = temp;
+	}
 }
 
 void Convoluter::applyOutput(juce::AudioBuffer<float>& buffer) {
 	auto numInputChannels = buffer.getNumChannels();
 
+	//hands back the block the last readInput convoluted
+	jassert(buffer.getNumSamples() == outputSamples);
 
 	for (int channel = 0; channel < numInputChannels; channel++) {
 		auto* writePointer = buffer.getWritePointer(channel);
-		auto* readPointer = outputBuffer.getReadPointer(channel, outputPos);
+		auto* readPointer = outputBuffer.getReadPointer(channel);
 
 		for (int i = 0; i < buffer.getNumSamples(); i++) {
 			writePointer[i] = readPointer[i];
-			//writePointer[i] = 1.0f / (float)i;
 		}
 
 	}
 
+}
 
-	outputPos += buffer.getNumSamples();
+bool Convoluter::isBypassed() const {
+	return bypassed;
+}
 
-	//if the output buffer at the end, reset the output buffer
-	if (outputPos + 1 >= bufferSize) {
-		outputPos = 0;
-		outputBuffer.clear();
-	}
+bool Convoluter::isLowDetail() const {
+	return lowDetail;
+}
 
+double Convoluter::getTailLengthSeconds() const {
+	//only the direct path's overflow rings unless the room is on
+	return (overflowSize + (room.enabled ? room.getTailLength() : 0)) / currSampleRate;
 }
 
 float Convoluter::correctAzimuth(float azimuth) {
@@ -239,6 +509,8 @@ int Convoluter::load_hrir_l() {
 
 	juce::File file = DATA_DIR.getChildFile("SoundStage/hrir_l.txt");
 
+	hrir_l.assign(25 * 50 * 200, 0.0f);
+
 	juce::String s = file.loadFileAsString();
 	if (!file.exists()) {
 		return -1;
@@ -252,7 +524,7 @@ int Convoluter::load_hrir_l() {
 	for (int i = 0; i < 25; i++) {
 		for (int j = 0; j < 50; j++) {
 			for (int k = 0; k < 200; k++) {
-				hrir_l[i][j][k] = stringArray[(i * 50 * 200) + (j * 200) + k].getFloatValue();
+				hrir_l[(i * 50 * 200) + (j * 200) + k] = stringArray[(i * 50 * 200) + (j * 200) + k].getFloatValue();
 			}
 		}
 	}
@@ -263,6 +535,8 @@ int Convoluter::load_hrir_l() {
 int Convoluter::load_hrir_r() {
 	juce::File file = DATA_DIR.getChildFile("SoundStage/hrir_r.txt");
 
+	hrir_r.assign(25 * 50 * 200, 0.0f);
+
 	juce::String s = file.loadFileAsString();
 	if (!file.exists()) {
 		juce::Logger::outputDebugString("failed to load right");
@@ -278,7 +552,7 @@ int Convoluter::load_hrir_r() {
 	for (int i = 0; i < 25; i++) {
 		for (int j = 0; j < 50; j++) {
 			for (int k = 0; k < 200; k++) {
-				hrir_r[i][j][k] = stringArray[(i * 50 * 200) + (j * 200) + k].getFloatValue();
+				hrir_r[(i * 50 * 200) + (j * 200) + k] = stringArray[(i * 50 * 200) + (j * 200) + k].getFloatValue();
 			}
 		}
 	}
@@ -286,15 +560,151 @@ int Convoluter::load_hrir_r() {
 	return 0;
 }
 
-float* Convoluter::get_hrir_l(int az, int elevation) {
-	float* value = hrir_l[az][elevation];
+void Convoluter::closest_hrir_indices(float azimuth, float elevation, int& azIndex, int& elIndex) {
+	azIndex = closest_azimuth_index(correctAzimuth(azimuth));
+	elIndex = closest_elevation_index(correctElevation(elevation, azimuth));
+}
+
+void Convoluter::find_onsets() {
+	//first tap within 20 dB of the peak, backed off a couple of samples
+	for (int i = 0; i < 25; i++) {
+		for (int j = 0; j < 50; j++) {
+			for (int ear = 0; ear < 2; ear++) {
+				const float* hrir = get_hrir(ear, i, j);
+				float peak = 0.0f;
+				int onset = 0;
 
-	return value;
+				for (int k = 0; k < 200; k++)
+					peak = juce::jmax(peak, std::abs(hrir[k]));
+
+				while (onset < 200 && std::abs(hrir[onset]) < 0.1f * peak)
+					onset++;
+
+				onset = juce::jlimit(0, 200 - lodHrirLength, onset - 2);
+
+				if (ear == 0)
+					hrir_onset_l[i][j] = onset;
+				else
+					hrir_onset_r[i][j] = onset;
+			}
+		}
+	}
 }
 
-float* Convoluter::get_hrir_r(int az, int elevation) {
-	float* value = hrir_r[az][elevation];
+const float* Convoluter::get_hrir_l(int az, int elevation) {
+	return get_hrir(0, az, elevation);
+}
 
+const float* Convoluter::get_hrir_r(int az, int elevation) {
+	return get_hrir(1, az, elevation);
+}
 
-	return value;
+/*
+* in the compact modes the filter is widened into a per ear scratch copy when it is
+* selected, which stays valid until the next lookup for the same ear
+*/
+const float* Convoluter::get_hrir(int ear, int az, int elevation) {
+	int offset = (az * 50 + elevation) * 200;
+
+	if (storage == HrirStorage::floatingPoint)
+		return (ear == 0 ? hrir_l.data() : hrir_r.data()) + offset;
+
+	offset += ear * 25 * 50 * 200;
+	float* dest = hrir_widened[ear];
+
+	if (storage == HrirStorage::halfFloat) {
+		widen_half(hrir_half.data() + offset, dest, 200);
+	}
+	else {
+		for (int block = 0; block < 200; block += hrirScaleBlock)
+			widen_int16(hrir_int16.data() + offset + block, hrir_scale[(offset + block) / hrirScaleBlock], dest + block, hrirScaleBlock);
+	}
+
+	return dest;
+}
+
+void Convoluter::setHrirStorage(HrirStorage mode) {
+	//coming back from a compact mode needs the float tables again
+	if (hrir_l.empty() || hrir_r.empty()) {
+		load_hrir_l();
+		load_hrir_r();
+	}
+
+	storage = HrirStorage::floatingPoint;
+	std::vector<uint16_t>().swap(hrir_half);
+	std::vector<int16_t>().swap(hrir_int16);
+	std::vector<float>().swap(hrir_scale);
+	storageErrorDb = -std::numeric_limits<float>::infinity();
+
+	if (mode == HrirStorage::floatingPoint)
+		return;
+
+	const int tapsPerEar = 25 * 50 * 200;
+	float peak = 0.0f;
+	float maxError = 0.0f;
+
+	if (mode == HrirStorage::halfFloat)
+		hrir_half.resize(2 * tapsPerEar);
+	else {
+		hrir_int16.resize(2 * tapsPerEar);
+		hrir_scale.resize(2 * tapsPerEar / hrirScaleBlock);
+	}
+
+	for (int ear = 0; ear < 2; ear++) {
+		const float* source = ear == 0 ? hrir_l.data() : hrir_r.data();
+
+		for (int block = 0; block < tapsPerEar; block += hrirScaleBlock) {
+			int offset = ear * tapsPerEar + block;
+			float blockPeak = 0.0f;
+
+			for (int k = 0; k < hrirScaleBlock; k++)
+				blockPeak = juce::jmax(blockPeak, std::abs(source[block + k]));
+
+			float scale = blockPeak > 0.0f ? blockPeak / 32767.0f : 1.0f;
+
+			//quantise, then widen straight back to measure what the mode costs us
+			for (int k = 0; k < hrirScaleBlock; k++) {
+				float original = source[block + k];
+				float widened;
+
+				if (mode == HrirStorage::halfFloat) {
+					hrir_half[offset + k] = float_to_half(original);
+					widened = half_to_float(hrir_half[offset + k]);
+				}
+				else {
+					hrir_int16[offset + k] = (int16_t)juce::roundToInt(original / scale);
+					widened = scale * hrir_int16[offset + k];
+				}
+
+				maxError = juce::jmax(maxError, std::abs(widened - original));
+			}
+
+			if (mode == HrirStorage::blockScaledInt16)
+				hrir_scale[offset / hrirScaleBlock] = scale;
+
+			peak = juce::jmax(peak, blockPeak);
+		}
+	}
+
+	storageErrorDb = 20.0f * std::log10(juce::jmax(maxError, 1.0e-12f) / juce::jmax(peak, 1.0e-12f));
+	storage = mode;
+
+	std::vector<float>().swap(hrir_l);
+	std::vector<float>().swap(hrir_r);
+}
+
+Convoluter::HrirStorage Convoluter::getHrirStorage() const {
+	return storage;
+}
+
+size_t Convoluter::getHrirResidentBytes() const {
+	return hrir_l.capacity() * sizeof(float)
+		+ hrir_r.capacity() * sizeof(float)
+		+ hrir_half.capacity() * sizeof(uint16_t)
+		+ hrir_int16.capacity() * sizeof(int16_t)
+		+ hrir_scale.capacity() * sizeof(float);
+}
+
+float Convoluter::getHrirStorageErrorDb() const {
+	return storageErrorDb;
 }
\ No newline at end of file
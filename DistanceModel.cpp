@@ -0,0 +1,209 @@
+/*
+  ==============================================================================
+
+    DistanceModel.cpp
+
+  ==============================================================================
+*/
+
+#include "DistanceModel.h"
+
+DistanceModel::DistanceModel() {
+	propagationDelay = true;
+	sampleRate = 44100.0;
+
+	delayPos = 0;
+	currentDelay = 0.0f;
+	fadeFromDelay = 0.0f;
+	fadeRemaining = 0;
+	currentGain = 1.0f;
+	airState = 0.0f;
+
+	shelfCoefficient = 0.0f;
+	shelfStateL = 0.0f;
+	shelfStateR = 0.0f;
+	currentShelfL = 1.0f;
+	currentShelfR = 1.0f;
+	shelfWrite = 0;
+
+	buildTable();
+}
+
+DistanceModel::~DistanceModel() {
+
+}
+
+void DistanceModel::prepare(double newSampleRate, int maximumBlockSize, float distance, int latencySamples) {
+	sampleRate = newSampleRate;
+
+	//longest propagation delay plus room to interpolate
+	delayLine.assign((size_t)(maxDistance / speedOfSound * sampleRate) + maximumBlockSize + 4, 0.0f);
+	delayPos = 0;
+	airState = 0.0f;
+	shelfStateL = 0.0f;
+	shelfStateR = 0.0f;
+
+	//the shelves share a fixed 1 kHz corner, only their gains move with distance
+	shelfCoefficient = std::exp(-juce::MathConstants<float>::twoPi * 1000.0f / (float)sampleRate);
+
+	buildTable();
+
+	//start settled at the current distance rather than gliding there from 1 m
+	Coefficients c = lookup(distance);
+	currentDelay = propagationDelay ? c.delay : 0.0f;
+	fadeFromDelay = currentDelay;
+	fadeRemaining = 0;
+	currentGain = c.gain;
+
+	ShelfTarget start = shelfTarget(c, 0.0f, 0.0f);
+	currentShelfL = start.left;
+	currentShelfR = start.right;
+
+	//one entry per block of latency, plus the block being written
+	int latencyBlocks = juce::roundToInt(latencySamples / (float)juce::jmax(1, maximumBlockSize));
+	shelfTargets.assign(latencyBlocks + 1, start);
+	shelfWrite = 0;
+}
+
+void DistanceModel::buildTable() {
+	static_assert(referenceIndex < tableSize, "the reference distance has to be in the table");
+
+	for (int i = 0; i < tableSize; i++) {
+		//entries are spaced evenly in log distance, the last one lies past maxDistance
+		float distance = minDistance * std::pow(referenceDistance / minDistance, i / (float)referenceIndex);
+		float excess = juce::jmax(0.0f, distance - referenceDistance);
+		float nearField = juce::jlimit(0.0f, 12.0f, -20.0f * std::log10(distance / referenceDistance));
+
+		table[i].gain = referenceDistance / distance;
+		table[i].nearFieldDb = nearField;
+		table[i].proximityDb = 0.25f * nearField;
+		table[i].delay = excess / speedOfSound * (float)sampleRate;
+
+		//the air past the reference takes the top off, down to about 7 kHz at 50 m
+		if (excess > 0.0f) {
+			float airCutoff = 333000.0f / excess;
+			table[i].airCoefficient = std::exp(-juce::MathConstants<float>::twoPi * airCutoff / (float)sampleRate);
+		}
+		else {
+			table[i].airCoefficient = 0.0f;
+		}
+	}
+}
+
+DistanceModel::Coefficients DistanceModel::lookup(float distance) {
+	distance = juce::jlimit(minDistance, maxDistance, distance);
+
+	float position = std::log(distance / minDistance) / std::log(referenceDistance / minDistance) * referenceIndex;
+	int index = juce::jlimit(0, tableSize - 2, (int)position);
+	float frac = position - index;
+	const Coefficients& a = table[index];
+	const Coefficients& b = table[index + 1];
+
+	return {
+		a.gain + frac * (b.gain - a.gain),
+		a.airCoefficient + frac * (b.airCoefficient - a.airCoefficient),
+		a.nearFieldDb + frac * (b.nearFieldDb - a.nearFieldDb),
+		a.proximityDb + frac * (b.proximityDb - a.proximityDb),
+		a.delay + frac * (b.delay - a.delay)
+	};
+}
+
+void DistanceModel::processInput(float* const* channels, int numChannels, int numSamples, float distance, float azimuth, float elevation) {
+	if (delayLine.empty() || numSamples <= 0)
+		return;
+
+	Coefficients c = lookup(distance);
+	float* data = channels[0];
+	int size = (int)delayLine.size();
+	float targetDelay = propagationDelay ? c.delay : 0.0f;
+	float gainStep = (c.gain - currentGain) / numSamples;
+
+	//a jump the glide could not cover within one crossfade switches taps instead of bending the pitch
+	if (fadeRemaining == 0 && std::abs(targetDelay - currentDelay) > maxDelayStep * crossfadeLength) {
+		fadeFromDelay = currentDelay;
+		currentDelay = targetDelay;
+		fadeRemaining = crossfadeLength;
+	}
+
+	for (int i = 0; i < numSamples; i++) {
+		delayLine[delayPos] = data[i];
+
+		//small moves glide, slowly enough that the doppler shift stays under 10 cents
+		if (fadeRemaining == 0)
+			currentDelay += juce::jlimit(-maxDelayStep, maxDelayStep, targetDelay - currentDelay);
+
+		float delayed = readDelay(currentDelay);
+
+		if (fadeRemaining > 0) {
+			float fade = fadeRemaining / (float)crossfadeLength;
+			delayed += fade * (readDelay(fadeFromDelay) - delayed);
+			fadeRemaining--;
+		}
+
+		airState = (1.0f - c.airCoefficient) * delayed + c.airCoefficient * airState;
+		currentGain += gainStep;
+		data[i] = currentGain * airState;
+
+		if (++delayPos >= size)
+			delayPos = 0;
+	}
+
+	currentGain = c.gain;
+
+	//the signal is mono by now, so every channel carries the same result
+	for (int channel = 1; channel < numChannels; channel++)
+		juce::FloatVectorOperations::copy(channels[channel], data, numSamples);
+
+	shelfTargets[shelfWrite] = shelfTarget(c, azimuth, elevation);
+	if (++shelfWrite >= (int)shelfTargets.size())
+		shelfWrite = 0;
+}
+
+float DistanceModel::readDelay(float delay) const {
+	int size = (int)delayLine.size();
+	float readPos = delayPos - delay;
+	if (readPos < 0.0f)
+		readPos += size;
+
+	int read0 = (int)readPos;
+	int read1 = read0 + 1 < size ? read0 + 1 : 0;
+	float frac = readPos - read0;
+
+	return delayLine[read0] + frac * (delayLine[read1] - delayLine[read0]);
+}
+
+DistanceModel::ShelfTarget DistanceModel::shelfTarget(const Coefficients& c, float azimuth, float elevation) {
+	//near field ILD grows with how far round to the side the source is, and fades out overhead
+	float lateral = SpatialMath::directionToVector(azimuth, elevation).x;
+
+	return {
+		std::pow(10.0f, (c.proximityDb - 0.5f * c.nearFieldDb * lateral) / 20.0f),
+		std::pow(10.0f, (c.proximityDb + 0.5f * c.nearFieldDb * lateral) / 20.0f)
+	};
+}
+
+void DistanceModel::processOutput(float* left, float* right, int numSamples) {
+	if (shelfTargets.empty() || numSamples <= 0)
+		return;
+
+	//the slot written next is the oldest, it went in with the block now coming out
+	float shelfL = shelfTargets[shelfWrite].left;
+	float shelfR = shelfTargets[shelfWrite].right;
+	float stepL = (shelfL - currentShelfL) / numSamples;
+	float stepR = (shelfR - currentShelfR) / numSamples;
+
+	//low shelf as the input plus a scaled one pole lowpass of it
+	for (int i = 0; i < numSamples; i++) {
+		shelfStateL = (1.0f - shelfCoefficient) * left[i] + shelfCoefficient * shelfStateL;
+		shelfStateR = (1.0f - shelfCoefficient) * right[i] + shelfCoefficient * shelfStateR;
+
+		currentShelfL += stepL;
+		currentShelfR += stepR;
+
+		left[i] += (currentShelfL - 1.0f) * shelfStateL;
+		right[i] += (currentShelfR - 1.0f) * shelfStateR;
+	}
+
+	currentShelfL = shelfL;
+	currentShelfR = shelfR;
+}
@@ -0,0 +1,86 @@
+/*
+  ==============================================================================
+
+    DistanceModel.h
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <vector>
+#include "SpatialMath.h"
+
+/*
+* Distance cues wrapped around the HRTF path, a handful of operations per sample.
+* Before the HRTF: inverse distance gain, a one pole air absorption lowpass and
+* the propagation delay. After the HRTF: near field ILD and proximity as one
+* pole low shelves on each ear. Coefficients come from a table indexed by
+* log distance and are refreshed once per sub-block. The shelf gains are worked
+* out as each block goes in and held back by the HRTF engine's latency, so they
+* always match the block coming out.
+* Every cue is measured from a 1 m reference, which sits exactly on a table entry
+* where the model passes the signal through untouched. Small distance changes
+* glide the delay with a doppler shift under 10 cents, bigger ones crossfade
+* from the old delay tap to the new one instead.
+*/
+class DistanceModel {
+    public:
+        DistanceModel();
+        ~DistanceModel();
+        void prepare(double sampleRate, int maximumBlockSize, float distance, int latencySamples);
+        void processInput(float* const* channels, int numChannels, int numSamples, float distance, float azimuth, float elevation);
+        void processOutput(float* left, float* right, int numSamples);
+        bool propagationDelay;
+
+        static constexpr float minDistance = 0.25f;
+        static constexpr float maxDistance = 50.0f;
+    private:
+        static constexpr int tableSize = 64;
+        static constexpr float referenceDistance = 1.0f;
+        //table entry that lands on the reference distance
+        static constexpr int referenceIndex = 16;
+        static constexpr float speedOfSound = 343.0f;
+        static constexpr float maxDelayStep = 0.005f;
+        static constexpr int crossfadeLength = 256;
+
+        struct Coefficients {
+            float gain;
+            float airCoefficient;
+            float nearFieldDb;
+            float proximityDb;
+            float delay;
+        };
+
+        struct ShelfTarget {
+            float left;
+            float right;
+        };
+
+        Coefficients table[tableSize];
+        double sampleRate;
+
+        std::vector<float> delayLine;
+        int delayPos;
+        float currentDelay;
+        float fadeFromDelay;
+        int fadeRemaining;
+        float currentGain;
+        float airState;
+
+        float shelfCoefficient;
+        float shelfStateL;
+        float shelfStateR;
+        float currentShelfL;
+        float currentShelfR;
+
+        //shelf gains per input block, read back once the audio they belong to leaves the HRTF path
+        std::vector<ShelfTarget> shelfTargets;
+        int shelfWrite;
+
+        void buildTable();
+        Coefficients lookup(float distance);
+        float readDelay(float delay) const;
+        ShelfTarget shelfTarget(const Coefficients& c, float azimuth, float elevation);
+};
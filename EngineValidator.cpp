@@ -0,0 +1,274 @@
+/*
+  ==============================================================================
+
+    EngineValidator.cpp
+
+  ==============================================================================
+*/
+
+#include "EngineValidator.h"
+
+EngineValidator::EngineValidator() {
+	reference = new Convoluter();
+}
+
+EngineValidator::~EngineValidator() {
+	delete reference;
+}
+
+void EngineValidator::generate(Signal signal, std::vector<float>& input, juce::Random& random) {
+	int numSamples = (int)input.size();
+
+	if (signal == Signal::impulses) {
+		//sparse clicks at random spacing, mostly silence so the idle paths get exercised too
+		std::fill(input.begin(), input.end(), 0.0f);
+
+		for (int i = random.nextInt(200); i < numSamples; i += 200 + random.nextInt(1000))
+			input[i] = 1.0f;
+
+		return;
+	}
+
+	for (int i = 0; i < numSamples; i++) {
+		if (signal == Signal::noise) {
+			input[i] = random.nextFloat() - 0.5f;
+		}
+		else if (signal == Signal::quietNoise) {
+			//peaks around 0.008, under the level the LOD threshold is normally set to
+			input[i] = 0.016f * (random.nextFloat() - 0.5f);
+		}
+		else {
+			//exponential sine sweep from 20 Hz to 20 kHz over the whole run
+			double t = i / sampleRate;
+			double duration = numSamples / sampleRate;
+			double rate = std::log(20000.0 / 20.0);
+			double phase = juce::MathConstants<double>::twoPi * 20.0 * duration / rate * (std::exp(t / duration * rate) - 1.0);
+			input[i] = 0.5f * (float)std::sin(phase);
+		}
+	}
+}
+
+int EngineValidator::findLatency(const std::vector<float>& expected, const std::vector<float>& actual, int guess) {
+	//only search close to where the engine says its latency is, a full search is far too slow
+	const int searchRadius = 64;
+	double best = -1.0;
+	int bestLag = -1;
+
+	for (int lag = juce::jmax(0, guess - searchRadius); lag <= guess + searchRadius; lag++) {
+		double sum = 0.0;
+		int count = juce::jmin((int)expected.size(), (int)actual.size() - lag);
+
+		for (int i = 0; i < count; i++)
+			sum += expected[i] * actual[i + lag];
+
+		if (sum > best) {
+			best = sum;
+			bestLag = lag;
+		}
+	}
+
+	return bestLag;
+}
+
+EngineValidator::Result EngineValidator::run(Convoluter& candidate, Signal signal, int blockSize, float toleranceDb, juce::int64 seed) {
+	juce::Random random(seed);
+
+	//the room is not part of the reference, it is switched back on when the run is done
+	bool roomEnabled = candidate.room.enabled;
+	candidate.room.enabled = false;
+	candidate.setSampleRate(sampleRate);
+	candidate.setSamplesPerBlock(blockSize);
+
+	int latency = candidate.getLatencySamples();
+	int numBlocks = (samplesPerRun + blockSize - 1) / blockSize;
+	int signalLength = numBlocks * blockSize;
+
+	//enough silent blocks afterwards to flush the latency and the overflow
+	int flushBlocks = (latency + 200) / blockSize + 1;
+	int totalLength = (numBlocks + flushBlocks) * blockSize;
+
+	std::vector<float> input(signalLength);
+	std::vector<float> expected[2] = { std::vector<float>(signalLength + 200, 0.0f), std::vector<float>(signalLength + 200, 0.0f) };
+	std::vector<float> actual[2] = { std::vector<float>(totalLength, 0.0f), std::vector<float>(totalLength, 0.0f) };
+	std::vector<float> response(blockSize + 200);
+	generate(signal, input, random);
+
+	juce::AudioBuffer<float> inputBlock(2, blockSize);
+	juce::AudioBuffer<float> outputBlock(2, blockSize);
+	float azimuth = random.nextFloat() * 360.0f;
+	float elevation = random.nextFloat() * 135.0f - 45.0f;
+
+	for (int block = 0; block < numBlocks + flushBlocks; block++) {
+		int start = block * blockSize;
+
+		//random walk over the sphere, one direction per block
+		azimuth += (random.nextFloat() - 0.5f) * 40.0f;
+		azimuth = azimuth < 0.0f ? azimuth + 360.0f : (azimuth >= 360.0f ? azimuth - 360.0f : azimuth);
+		elevation = juce::jlimit(-45.0f, 90.0f, elevation + (random.nextFloat() - 0.5f) * 20.0f);
+
+		for (int channel = 0; channel < 2; channel++) {
+			for (int i = 0; i < blockSize; i++)
+				inputBlock.setSample(channel, i, start + i < signalLength ? input[start + i] : 0.0f);
+		}
+
+		candidate.azimuth = azimuth;
+		candidate.elevation = elevation;
+		candidate.readInput(inputBlock);
+		candidate.applyOutput(outputBlock);
+
+		for (int channel = 0; channel < 2; channel++) {
+			for (int i = 0; i < blockSize; i++)
+				actual[channel][start + i] = outputBlock.getSample(channel, i);
+		}
+
+		if (block >= numBlocks)
+			continue;
+
+		//the reference is linear, so each block's response can be added in on its own
+		int azIndex, elIndex;
+		reference->closest_hrir_indices(azimuth, elevation, azIndex, elIndex);
+
+		for (int channel = 0; channel < 2; channel++) {
+			const float* hrir = channel == 0 ? reference->get_hrir_l(azIndex, elIndex) : reference->get_hrir_r(azIndex, elIndex);
+
+			Convoluter::reference_convolute(input.data() + start, blockSize, hrir, response.data());
+			for (int i = 0; i < blockSize + 200; i++)
+				expected[channel][start + i] += response[i];
+		}
+	}
+
+	Result result;
+	result.signal = signal;
+	result.blockSize = blockSize;
+	result.expectedLatency = latency;
+	result.measuredLatency = findLatency(expected[0], actual[0], latency);
+
+	float peak = 0.0f;
+	float maxError = 0.0f;
+	for (int channel = 0; channel < 2; channel++) {
+		for (int i = 0; i < signalLength + 200; i++) {
+			peak = juce::jmax(peak, std::abs(expected[channel][i]));
+			maxError = juce::jmax(maxError, std::abs(expected[channel][i] - actual[channel][i + latency]));
+		}
+	}
+
+	result.maxAbsError = maxError;
+	result.errorDb = 20.0f * std::log10(juce::jmax(maxError, 1.0e-12f) / juce::jmax(peak, 1.0e-12f));
+	result.passed = result.measuredLatency == latency && result.errorDb <= toleranceDb;
+
+	candidate.room.enabled = roomEnabled;
+	return result;
+}
+
+bool EngineValidator::runAll(Convoluter& candidate, float toleranceDb, std::vector<Result>& results) {
+	static const int blockSizes[] = { 32, 64, 128, 256, 480, 512, 1024 };
+	static const Signal signals[] = { Signal::noise, Signal::impulses, Signal::sweep };
+	bool allPassed = true;
+	juce::int64 seed = 1;
+
+	for (Signal signal : signals) {
+		for (int blockSize : blockSizes) {
+			results.push_back(run(candidate, signal, blockSize, toleranceDb, seed++));
+			allPassed = allPassed && results.back().passed;
+		}
+	}
+
+	return allPassed;
+}
+
+juce::String EngineValidator::describe(const Result& result) {
+	static const char* names[] = { "noise", "quiet noise", "impulses", "sweep" };
+
+	return juce::String(names[(int)result.signal])
+		+ " block " + juce::String(result.blockSize)
+		+ ": max error " + juce::String(result.maxAbsError)
+		+ " (" + juce::String(result.errorDb, 1) + " dB)"
+		+ ", latency " + juce::String(result.measuredLatency) + "/" + juce::String(result.expectedLatency)
+		+ (result.passed ? " PASS" : " FAIL");
+}
+
+#if SOUNDSTAGE_RUN_TESTS
+/*
+* The null test as a juce::UnitTest, registered only in the test runner build
+* (Tests/SoundStageTests.cpp) so it never ships in the plugin. The tolerances
+* sit a few dB above what each configuration measures.
+*/
+class EngineValidatorTest : public juce::UnitTest {
+	public:
+		EngineValidatorTest() : juce::UnitTest("HRTF engine null test", "SoundStage") {}
+
+		void runTest() override {
+			static const int blockSizes[] = { 32, 128, 480, 1024 };
+			EngineValidator validator;
+			Convoluter candidate;
+			std::vector<EngineValidator::Result> results;
+			juce::int64 seed = 100;
+
+			beginTest("Full detail float HRIRs null against the reference");
+			validator.runAll(candidate, fullDetailDb, results);
+			expectResults(results, fullDetailDb);
+
+			beginTest("Quiet input nulls down to the silence gate");
+			for (int blockSize : blockSizes)
+				expectResult(validator.run(candidate, EngineValidator::Signal::quietNoise, blockSize, quietDb, seed++), quietDb);
+
+			beginTest("Blocks under lodThreshold drop to low detail, louder ones do not");
+			candidate.lodThreshold = 0.01f;
+			for (int blockSize : blockSizes) {
+				EngineValidator::Result quiet = validator.run(candidate, EngineValidator::Signal::quietNoise, blockSize, lowDetailDb, seed++);
+				expectResult(quiet, lowDetailDb);
+				expectGreaterThan(quiet.errorDb, fullDetailDb, "low detail never engaged: " + EngineValidator::describe(quiet));
+
+				expectResult(validator.run(candidate, EngineValidator::Signal::noise, blockSize, fullDetailDb, seed++), fullDetailDb);
+			}
+			candidate.lodThreshold = 0.0f;
+
+			beginTest("Low priority stays within the low detail bound");
+			candidate.lowPriority = true;
+			for (int blockSize : blockSizes)
+				expectResult(validator.run(candidate, EngineValidator::Signal::noise, blockSize, lowDetailDb, seed++), lowDetailDb);
+			candidate.lowPriority = false;
+
+			beginTest("Half float HRIR storage");
+			candidate.setHrirStorage(Convoluter::HrirStorage::halfFloat);
+			results.clear();
+			validator.runAll(candidate, halfFloatDb, results);
+			expectResults(results, halfFloatDb);
+
+			beginTest("Block scaled int16 HRIR storage");
+			candidate.setHrirStorage(Convoluter::HrirStorage::blockScaledInt16);
+			results.clear();
+			validator.runAll(candidate, blockScaledInt16Db, results);
+			expectResults(results, blockScaledInt16Db);
+			candidate.setHrirStorage(Convoluter::HrirStorage::floatingPoint);
+
+			beginTest("A run leaves the room switched the way it found it");
+			candidate.room.enabled = true;
+			validator.run(candidate, EngineValidator::Signal::impulses, 128, fullDetailDb, seed++);
+			expect(candidate.room.enabled);
+		}
+
+	private:
+		//measured: about -118, -90, -17 to -28, -62 and -84 dB
+		static constexpr float fullDetailDb = -100.0f;
+		//tails under Convoluter::silenceThreshold are dropped, about 90 dB under this signal
+		static constexpr float quietDb = -80.0f;
+		static constexpr float lowDetailDb = -12.0f;
+		static constexpr float halfFloatDb = -55.0f;
+		static constexpr float blockScaledInt16Db = -75.0f;
+
+		void expectResult(const EngineValidator::Result& result, float toleranceDb) {
+			juce::String description = EngineValidator::describe(result);
+
+			expectEquals(result.measuredLatency, result.expectedLatency, "latency: " + description);
+			expectLessOrEqual(result.errorDb, toleranceDb, "error: " + description);
+		}
+
+		void expectResults(const std::vector<EngineValidator::Result>& results, float toleranceDb) {
+			for (const EngineValidator::Result& result : results)
+				expectResult(result, toleranceDb);
+		}
+};
+
+static EngineValidatorTest engineValidatorTest;
+#endif
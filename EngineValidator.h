@@ -0,0 +1,58 @@
+/*
+  ==============================================================================
+
+    EngineValidator.h
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <vector>
+#include "Convoluter.h"
+
+/*
+* Null test for the convolution engine. The reference is the original time
+* domain loop (Convoluter::reference_convolute) run offline over the whole
+* signal with float HRIRs. A candidate Convoluter, configured however we want
+* to ship it, is streamed the same input block by block while the direction
+* wanders randomly. Its output is lined up at the expected latency and compared
+* sample by sample.
+* A run leaves the candidate prepared at the validator's sample rate and the
+* run's block size, so prepare it again before using it for anything else.
+* Its room enabled flag is put back the way it was.
+*/
+class EngineValidator {
+    public:
+        enum class Signal {
+            noise,
+            quietNoise,
+            impulses,
+            sweep
+        };
+
+        struct Result {
+            Signal signal;
+            int blockSize;
+            float maxAbsError;
+            float errorDb;
+            int expectedLatency;
+            int measuredLatency;
+            bool passed;
+        };
+
+        EngineValidator();
+        ~EngineValidator();
+        Result run(Convoluter& candidate, Signal signal, int blockSize, float toleranceDb, juce::int64 seed);
+        bool runAll(Convoluter& candidate, float toleranceDb, std::vector<Result>& results);
+        static juce::String describe(const Result& result);
+    private:
+        static constexpr int samplesPerRun = 16384;
+        static constexpr double sampleRate = 44100.0;
+
+        Convoluter* reference;
+
+        void generate(Signal signal, std::vector<float>& input, juce::Random& random);
+        int findLatency(const std::vector<float>& expected, const std::vector<float>& actual, int guess);
+};
@@ -0,0 +1,130 @@
+/*
+  ==============================================================================
+
+    HeadTracker.cpp
+
+  ==============================================================================
+*/
+
+#include "HeadTracker.h"
+
+static const char* orientationAddress = "/head/ypr";
+
+HeadTracker::HeadTracker() : juce::Thread("SoundStage head tracker") {
+	listening = false;
+	port = defaultPort;
+	users = 0;
+}
+
+HeadTracker::~HeadTracker() {
+	stopThread(500);
+}
+
+bool HeadTracker::read(Orientation& orientation, uint32_t& lastSeen) const {
+	return latest.read(orientation, lastSeen);
+}
+
+bool HeadTracker::isListening() const {
+	return listening;
+}
+
+void HeadTracker::startListening(int newPort) {
+	const juce::ScopedLock lock(userLock);
+	users++;
+
+	if (isThreadRunning() && newPort == port)
+		return;
+
+	//moving to another port rebinds for every instance
+	stopThread(500);
+	port = newPort;
+	startThread();
+}
+
+void HeadTracker::stopListening() {
+	const juce::ScopedLock lock(userLock);
+	users = juce::jmax(0, users - 1);
+
+	if (users == 0)
+		stopThread(500);
+}
+
+void HeadTracker::run() {
+	juce::DatagramSocket socket(false);
+
+	if (!socket.bindToPort(port, "127.0.0.1")) {
+		juce::Logger::outputDebugString("head tracker could not bind port " + juce::String(port));
+		return;
+	}
+
+	listening = true;
+	char data[512];
+
+	while (!threadShouldExit()) {
+		//short timeout so the thread notices when it is asked to stop
+		if (socket.waitUntilReady(true, 50) != 1)
+			continue;
+
+		int size = socket.read(data, sizeof(data), false);
+		Orientation orientation;
+
+		if (size > 0 && parseMessage(data, size, orientation)) {
+			orientation.receivedTicks = juce::Time::getHighResolutionTicks();
+			latest.write(orientation);
+		}
+	}
+
+	listening = false;
+}
+
+int HeadTracker::paddedLength(int length) {
+	//OSC strings are null terminated and padded out to 4 bytes
+	return (length + 4) & ~3;
+}
+
+bool HeadTracker::parseMessage(const char* data, int size, Orientation& orientation) {
+	int addressLength = (int)strnlen(data, (size_t)size);
+	if (addressLength == size || strcmp(data, orientationAddress) != 0)
+		return false;
+
+	int pos = paddedLength(addressLength);
+	if (pos + 4 > size || strncmp(data + pos, ",fff", 4) != 0)
+		return false;
+
+	pos += paddedLength(4);
+	if (pos + 12 > size)
+		return false;
+
+	float values[3];
+	for (int i = 0; i < 3; i++) {
+		uint32_t bits = juce::ByteOrder::bigEndianInt(data + pos + 4 * i);
+		std::memcpy(&values[i], &bits, sizeof(float));
+	}
+
+	orientation.yaw = values[0];
+	orientation.pitch = values[1];
+	orientation.roll = values[2];
+	return true;
+}
+
+bool HeadTracker::sendOrientation(float yaw, float pitch, float roll, int port) {
+	char data[32] = {};
+	int pos = 0;
+
+	std::memcpy(data, orientationAddress, strlen(orientationAddress));
+	pos += paddedLength((int)strlen(orientationAddress));
+	std::memcpy(data + pos, ",fff", 4);
+	pos += paddedLength(4);
+
+	float values[3] = { yaw, pitch, roll };
+	for (int i = 0; i < 3; i++) {
+		uint32_t bits;
+		std::memcpy(&bits, &values[i], sizeof(float));
+		bits = juce::ByteOrder::swapIfLittleEndian(bits);
+		std::memcpy(data + pos, &bits, sizeof(float));
+		pos += 4;
+	}
+
+	juce::DatagramSocket socket(false);
+	return socket.write("127.0.0.1", port, data, pos) == pos;
+}
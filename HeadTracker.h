@@ -0,0 +1,57 @@
+/*
+  ==============================================================================
+
+    HeadTracker.h
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "LatestValue.h"
+
+/*
+* Listens on localhost for OSC head tracking messages on its own thread:
+*
+*     /head/ypr ,fff  yaw pitch roll   (degrees)
+*
+* Yaw is positive turning right, pitch is positive looking up and roll is
+* positive with the right ear down. Every plugin instance in the process shares
+* one tracker through a juce::SharedResourcePointer and pulls the latest
+* orientation from the audio thread without locking.
+* Nothing is bound until an instance switches tracking on. The socket stays open
+* while any instance wants it, on the port most recently asked for.
+*/
+class HeadTracker : public juce::Thread {
+    public:
+        struct Orientation {
+            float yaw;
+            float pitch;
+            float roll;
+            juce::int64 receivedTicks;
+        };
+
+        static constexpr int defaultPort = 9000;
+
+        HeadTracker();
+        ~HeadTracker() override;
+        bool read(Orientation& orientation, uint32_t& lastSeen) const;
+        bool isListening() const;
+        void startListening(int port);
+        void stopListening();
+
+        //local test sender, fires a single orientation packet at the tracker
+        static bool sendOrientation(float yaw, float pitch, float roll, int port = defaultPort);
+
+    private:
+        LatestValue<Orientation> latest;
+        std::atomic<bool> listening;
+        int port;
+        int users;
+        juce::CriticalSection userLock;
+
+        void run() override;
+        bool parseMessage(const char* data, int size, Orientation& orientation);
+        static int paddedLength(int length);
+};
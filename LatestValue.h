@@ -0,0 +1,68 @@
+/*
+  ==============================================================================
+
+    LatestValue.h
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+/*
+* Single writer, many reader slot that always holds the most recent value.
+* Neither side ever blocks: a reader that catches the writer mid update just
+* gets false and keeps whatever it had, then tries again next sub-block.
+* Each reader keeps its own sequence number so it can tell when something new arrived.
+*/
+template <typename T>
+class LatestValue {
+    public:
+        LatestValue() {
+            for (auto& word : words)
+                word.store(0, std::memory_order_relaxed);
+        }
+
+        void write(const T& value) {
+            uint32_t seq = sequence.load(std::memory_order_relaxed);
+            sequence.store(seq + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+
+            uint32_t packed[numWords] = {};
+            std::memcpy(packed, &value, sizeof(T));
+            for (int i = 0; i < numWords; i++)
+                words[i].store(packed[i], std::memory_order_relaxed);
+
+            sequence.store(seq + 2, std::memory_order_release);
+        }
+
+        bool read(T& value, uint32_t& lastSeen) const {
+            uint32_t before = sequence.load(std::memory_order_acquire);
+
+            if (before == lastSeen || (before & 1) != 0)
+                return false;
+
+            uint32_t packed[numWords];
+            for (int i = 0; i < numWords; i++)
+                packed[i] = words[i].load(std::memory_order_relaxed);
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (sequence.load(std::memory_order_relaxed) != before)
+                return false;
+
+            std::memcpy(&value, packed, sizeof(T));
+            lastSeen = before;
+            return true;
+        }
+
+    private:
+        static_assert(std::is_trivially_copyable<T>::value, "LatestValue needs a plain struct");
+        static constexpr int numWords = (int)((sizeof(T) + sizeof(uint32_t) - 1) / sizeof(uint32_t));
+
+        std::atomic<uint32_t> words[numWords];
+        std::atomic<uint32_t> sequence{ 0 };
+};
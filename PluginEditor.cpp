@@ -33,16 +33,90 @@ SoundStageAudioProcessorEditor::SoundStageAudioProcessorEditor (SoundStageAudioP
     azimuthControl.addListener(this);
     addAndMakeVisible(azimuthControl);
 
+    // ROOM SLIDER SETTINGS
+    roomControl.setSliderStyle(juce::Slider::SliderStyle::LinearHorizontal);
+    roomControl.setRange(0.f, 1.f, 0.01f);
+    roomControl.setValue(audioProcessor.roomLevel);
+    roomControl.setTextBoxStyle(juce::Slider::TextBoxRight, 0, 50, 25);
+    roomControl.addListener(this);
+    addAndMakeVisible(roomControl);
+
+    // DISTANCE SLIDER SETTINGS
+    distanceControl.setSliderStyle(juce::Slider::SliderStyle::LinearHorizontal);
+    distanceControl.setRange(DistanceModel::minDistance, DistanceModel::maxDistance, 0.01f);
+    distanceControl.setSkewFactorFromMidPoint(4.0);
+    distanceControl.setValue(audioProcessor.distance);
+    distanceControl.setTextBoxStyle(juce::Slider::TextBoxRight, 0, 50, 25);
+    distanceControl.addListener(this);
+    addAndMakeVisible(distanceControl);
+
+    // ORBIT SLIDER SETTINGS
+    orbitControl.setSliderStyle(juce::Slider::SliderStyle::LinearHorizontal);
+    orbitControl.setRange(-180.f, 180.f, 1.f);
+    orbitControl.setValue(0.f);
+    orbitControl.setTextBoxStyle(juce::Slider::TextBoxRight, 0, 50, 25);
+    orbitControl.addListener(this);
+    addAndMakeVisible(orbitControl);
+
+    // HEAD TRACKING SETTINGS, off until asked for so no OSC sender can turn the mix by accident
+    trackingControl.setButtonText("HEAD TRACKING");
+    trackingControl.setToggleState(audioProcessor.headTrackingEnabled, juce::NotificationType::dontSendNotification);
+    trackingControl.addListener(this);
+    addAndMakeVisible(trackingControl);
+
+    trackingPortControl.setSliderStyle(juce::Slider::SliderStyle::IncDecButtons);
+    trackingPortControl.setRange(1024.f, 65535.f, 1.f);
+    trackingPortControl.setValue(audioProcessor.headTrackingPort, juce::NotificationType::dontSendNotification);
+    trackingPortControl.setTextBoxStyle(juce::Slider::TextBoxLeft, false, 60, 25);
+    trackingPortControl.addListener(this);
+    addAndMakeVisible(trackingPortControl);
+
+    // LEVEL OF DETAIL SETTINGS, trades accuracy for CPU so both start off
+    lowPriorityControl.setButtonText("LOW PRIORITY");
+    lowPriorityControl.setToggleState(audioProcessor.lowPriority, juce::NotificationType::dontSendNotification);
+    lowPriorityControl.addListener(this);
+    addAndMakeVisible(lowPriorityControl);
+
+    lodControl.setSliderStyle(juce::Slider::SliderStyle::LinearHorizontal);
+    lodControl.setRange(lodOffDb, -20.f, 1.f);
+    lodControl.setValue(juce::Decibels::gainToDecibels(audioProcessor.lodThreshold, lodOffDb));
+    lodControl.textFromValueFunction = [](double value) {
+        return value <= lodOffDb ? juce::String("OFF") : juce::String((int)value) + " dB";
+    };
+    lodControl.setTextBoxStyle(juce::Slider::TextBoxRight, 0, 50, 25);
+    lodControl.addListener(this);
+    addAndMakeVisible(lodControl);
+
     // LABEL SETTINGS
     azLabel.setText("AZIMUTH", juce::NotificationType::dontSendNotification);
     elLabel.setText("ELEVATION", juce::NotificationType::dontSendNotification);
+    roomLabel.setText("ROOM", juce::NotificationType::dontSendNotification);
+    distanceLabel.setText("DISTANCE", juce::NotificationType::dontSendNotification);
+    orbitLabel.setText("ORBIT", juce::NotificationType::dontSendNotification);
+    trackingPortLabel.setText("PORT", juce::NotificationType::dontSendNotification);
+    lodLabel.setText("LOD", juce::NotificationType::dontSendNotification);
     azLabel.setEditable(false);
     elLabel.setEditable(false);
+    roomLabel.setEditable(false);
+    distanceLabel.setEditable(false);
+    orbitLabel.setEditable(false);
+    trackingPortLabel.setEditable(false);
+    lodLabel.setEditable(false);
     azLabel.setJustificationType(juce::Justification::centred);
     azLabel.attachToComponent(&azimuthControl, false);
     elLabel.attachToComponent(&elevationControl, true);
+    roomLabel.attachToComponent(&roomControl, true);
+    distanceLabel.attachToComponent(&distanceControl, true);
+    orbitLabel.attachToComponent(&orbitControl, true);
+    trackingPortLabel.attachToComponent(&trackingPortControl, true);
+    lodLabel.attachToComponent(&lodControl, true);
     addAndMakeVisible(azLabel);
     addAndMakeVisible(elLabel);
+    addAndMakeVisible(roomLabel);
+    addAndMakeVisible(distanceLabel);
+    addAndMakeVisible(orbitLabel);
+    addAndMakeVisible(trackingPortLabel);
+    addAndMakeVisible(lodLabel);
 
     // COLOR SCHEME SETTINGS
     getLookAndFeel().setColour(juce::Slider::thumbColourId, juce::Colours::purple);
@@ -52,7 +126,7 @@ SoundStageAudioProcessorEditor::SoundStageAudioProcessorEditor (SoundStageAudioP
     getLookAndFeel().setColour(juce::Slider::rotarySliderOutlineColourId, juce::Colours::black);
     getLookAndFeel().setColour(juce::ResizableWindow::backgroundColourId, juce::Colours::darkgrey);
 
-    setSize (400, 300);
+    setSize (400, 485);
 }
 
 SoundStageAudioProcessorEditor::~SoundStageAudioProcessorEditor()
@@ -75,8 +149,18 @@ void SoundStageAudioProcessorEditor::resized()
     // This is generally where you'll want to lay out the positions of any
     // subcomponents in your editor..
 
-    elevationControl.setBounds(3 * getWidth() / 4, getHeight()/8, 100, 3 * getHeight() / 4);
+    // keep the direction controls clear of the sliders along the bottom
+    int directionHeight = getHeight() - 190;
+
+    elevationControl.setBounds(3 * getWidth() / 4, directionHeight/8, 100, 3 * directionHeight / 4);
     azimuthControl.setBounds(0, 65, 200, 200);
+    lowPriorityControl.setBounds(10, getHeight() - 180, 130, 25);
+    lodControl.setBounds(190, getHeight() - 180, getWidth() - 210, 25);
+    trackingControl.setBounds(10, getHeight() - 145, 150, 25);
+    trackingPortControl.setBounds(getWidth() - 170, getHeight() - 145, 150, 25);
+    orbitControl.setBounds(70, getHeight() - 110, getWidth() - 90, 25);
+    distanceControl.setBounds(70, getHeight() - 75, getWidth() - 90, 25);
+    roomControl.setBounds(70, getHeight() - 40, getWidth() - 90, 25);
     
 }
 
@@ -89,4 +173,43 @@ void SoundStageAudioProcessorEditor::sliderValueChanged(juce::Slider* slider)
     if (slider == &azimuthControl) {
         audioProcessor.azimuth = azimuthControl.getValue();
     }
+
+    if (slider == &roomControl) {
+        audioProcessor.roomLevel = roomControl.getValue();
+    }
+
+    if (slider == &distanceControl) {
+        audioProcessor.distance = distanceControl.getValue();
+    }
+
+    // the orbit runs on the audio thread from here on, locked to the host timeline.
+    // it starts from the slider direction, moving the slider again only changes the rate
+    if (slider == &orbitControl) {
+        TrajectoryEngine::Trajectory orbit = TrajectoryEngine::orbit(
+            orbitControl.getValue(), azimuthControl.getValue(), elevationControl.getValue());
+
+        if (orbitControl.getValue() == 0.0)
+            orbit.mode = TrajectoryEngine::Mode::off;
+
+        audioProcessor.setTrajectory(orbit);
+    }
+
+    if (slider == &lodControl) {
+        audioProcessor.lodThreshold = juce::Decibels::decibelsToGain((float)lodControl.getValue(), lodOffDb);
+    }
+
+    if (slider == &trackingPortControl && audioProcessor.headTrackingEnabled) {
+        audioProcessor.setHeadTracking(true, (int)trackingPortControl.getValue());
+    }
+}
+
+void SoundStageAudioProcessorEditor::buttonClicked(juce::Button* button)
+{
+    if (button == &trackingControl) {
+        audioProcessor.setHeadTracking(trackingControl.getToggleState(), (int)trackingPortControl.getValue());
+    }
+
+    if (button == &lowPriorityControl) {
+        audioProcessor.lowPriority = lowPriorityControl.getToggleState();
+    }
 }
\ No newline at end of file
@@ -15,7 +15,8 @@
 /**
 */
 class SoundStageAudioProcessorEditor  : public juce::AudioProcessorEditor,
-                                        public juce::Slider::Listener
+                                        public juce::Slider::Listener,
+                                        public juce::Button::Listener
 {
 public:
     SoundStageAudioProcessorEditor (SoundStageAudioProcessor&);
@@ -26,6 +27,7 @@ public:
     void resized() override;
 
     void sliderValueChanged (juce::Slider* slider) override;
+    void buttonClicked (juce::Button* button) override;
 
 private:
     // This reference is provided as a quick way for your editor to
@@ -35,9 +37,24 @@ private:
 
     juce::Slider elevationControl;
     juce::Slider azimuthControl;
+    juce::Slider roomControl;
+    juce::Slider distanceControl;
+    juce::Slider orbitControl;
+    juce::Slider trackingPortControl;
+    juce::ToggleButton trackingControl;
+    juce::Slider lodControl;
+    juce::ToggleButton lowPriorityControl;
     
     juce::Label azLabel;
     juce::Label elLabel;
+    juce::Label roomLabel;
+    juce::Label distanceLabel;
+    juce::Label orbitLabel;
+    juce::Label trackingPortLabel;
+    juce::Label lodLabel;
+
+    // the bottom of the LOD slider switches the threshold off
+    static constexpr float lodOffDb = -90.0f;
 
     
     SoundStageAudioProcessor& audioProcessor;
@@ -24,11 +24,24 @@ SoundStageAudioProcessor::SoundStageAudioProcessor()
 {
 	azimuth = 0;
 	elevation = 0;
+	roomLevel = 0.0f;
+	distance = 1.0f;
+	headTrackingEnabled = false;
+	headTrackingPort = HeadTracker::defaultPort;
+	lowPriority = false;
+	lodThreshold = 0.0f;
+	hrirStorage = Convoluter::HrirStorage::floatingPoint;
+	listenerOrientation = { 0.0f, 0.0f, 0.0f, 0 };
+	lastOrientationSequence = 0;
+	headTrackingLatencyMs = 0.0;
 	convoluter = new Convoluter();
 }
 
 SoundStageAudioProcessor::~SoundStageAudioProcessor()
 {
+	if (headTrackingEnabled)
+		headTracker->stopListening();
+
 	delete convoluter;
 	delete this->conv;
 }
@@ -68,7 +81,7 @@ bool SoundStageAudioProcessor::isMidiEffect() const
 
 double SoundStageAudioProcessor::getTailLengthSeconds() const
 {
-	return 0.0;
+	return convoluter->getTailLengthSeconds();
 }
 
 int SoundStageAudioProcessor::getNumPrograms()
@@ -101,7 +114,17 @@ void SoundStageAudioProcessor::prepareToPlay(double sampleRate, int samplesPerBl
 	// Use this method as the place to do any pre-playback
 	// initialisation that you need..
 
-	convoluter->setSamplesPerBlock(samplesPerBlock);
+	//storage conversion rebuilds the tables, so it only happens here and never on the audio thread
+	if (convoluter->getHrirStorage() != hrirStorage)
+		convoluter->setHrirStorage(hrirStorage);
+
+	//processBlock only ever hands the engines sub-blocks, whatever block size the host prepares with
+	convoluter->setSampleRate(sampleRate);
+	convoluter->setSamplesPerBlock(subBlockSize);
+	setLatencySamples(convoluter->getLatencySamples());
+	inputCopy.setSize(getTotalNumInputChannels(), samplesPerBlock);
+	distanceModel.prepare(sampleRate, subBlockSize, distance, convoluter->getLatencySamples());
+	trajectory.prepare(sampleRate);
 
 }
 
@@ -173,15 +196,44 @@ void SoundStageAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer, ju
 		buffer.setSample(1, sample, monoSummed);
 	}
 
-	juce::AudioBuffer<float> bufferCopy;
-	bufferCopy.makeCopyOf(buffer);
-
-	convoluter->elevation = elevation;
-	convoluter->azimuth = azimuth;
+	int numSamples = buffer.getNumSamples();
+	int numChannels = buffer.getNumChannels();
+
+	inputCopy.setSize(numChannels, numSamples, false, false, true);
+	for (int channel = 0; channel < numChannels; channel++)
+		inputCopy.copyFrom(channel, 0, buffer, channel, 0, numSamples);
+
+	convoluter->room.level = roomLevel;
+	convoluter->room.enabled = roomLevel > 0.0f;
+	convoluter->lowPriority = lowPriority;
+	convoluter->lodThreshold = lodThreshold;
+	convoluter->room.setSourceDistance(juce::jlimit(DistanceModel::minDistance, DistanceModel::maxDistance, distance));
+
+	juce::AudioPlayHead::CurrentPositionInfo position;
+	juce::AudioPlayHead* playHead = getPlayHead();
+
+	if (playHead != nullptr && playHead->getCurrentPosition(position))
+		trajectory.beginBlock(true, position.isPlaying, position.ppqPosition, position.bpm, position.timeInSeconds);
+	else
+		trajectory.beginBlock(false, false, 0.0, 120.0, 0.0);
+
+	//split the block so the source direction follows the listener's head within it
+	for (int start = 0; start < numSamples; start += subBlockSize) {
+		int length = juce::jmin(subBlockSize, numSamples - start);
+		juce::AudioBuffer<float> output(buffer.getArrayOfWritePointers(), numChannels, start, length);
+		juce::AudioBuffer<float> input(inputCopy.getArrayOfWritePointers(), numChannels, start, length);
+
+		updateDirection(start);
+
+		//distance is applied around the HRTF path, gain, air and delay before it, near field shelves after
+		distanceModel.processInput(input.getArrayOfWritePointers(), numChannels, length, distance, convoluter->azimuth, convoluter->elevation);
+		convoluter->readInput(input);
+		convoluter->applyOutput(output);
+		if (numChannels > 1)
+			distanceModel.processOutput(output.getWritePointer(0), output.getWritePointer(1), length);
+	}
 
-	convoluter->applyOutput(buffer);
-	convoluter->readInput(bufferCopy);
-	
+	trajectory.endBlock(numSamples);
 	
 }
 
@@ -189,6 +241,70 @@ void SoundStageAudioProcessor::updateParameters() {
 
 }
 
+void SoundStageAudioProcessor::setTrajectory(const TrajectoryEngine::Trajectory& newTrajectory) {
+	trajectory.setTrajectory(newTrajectory);
+}
+
+void SoundStageAudioProcessor::setHeadTracking(bool enabled, int port) {
+	if (headTrackingEnabled)
+		headTracker->stopListening();
+
+	headTrackingPort = port;
+	headTrackingEnabled = enabled;
+
+	if (enabled)
+		headTracker->startListening(port);
+}
+
+void SoundStageAudioProcessor::updateDirection(int sampleOffset) {
+	HeadTracker::Orientation latest;
+	float sourceAzimuth = azimuth;
+	float sourceElevation = elevation;
+
+	//a running trajectory takes over from the sliders
+	trajectory.evaluate(sampleOffset, sourceAzimuth, sourceElevation);
+
+	/*
+	* time from the packet landing on the network thread to the first output sample
+	* rendered with it: the wait for the audio thread, where this sub-block sits in
+	* the host block, and whatever latency the engine reports
+	*/
+	if (headTracker->read(latest, lastOrientationSequence)) {
+		listenerOrientation = latest;
+		juce::int64 ticks = juce::Time::getHighResolutionTicks() - latest.receivedTicks;
+		double renderSeconds = (sampleOffset + convoluter->getLatencySamples()) / getSampleRate();
+		headTrackingLatencyMs = (juce::Time::highResolutionTicksToSeconds(ticks) + renderSeconds) * 1000.0;
+	}
+
+	bool isRotated = listenerOrientation.yaw != 0.0f
+		|| listenerOrientation.pitch != 0.0f
+		|| listenerOrientation.roll != 0.0f;
+
+	if (headTrackingEnabled && isRotated) {
+		juce::int64 age = juce::Time::getHighResolutionTicks() - listenerOrientation.receivedTicks;
+		isRotated = juce::Time::highResolutionTicksToSeconds(age) < orientationTimeoutSeconds;
+	}
+
+	if (!headTrackingEnabled || !isRotated) {
+		convoluter->azimuth = sourceAzimuth;
+		convoluter->elevation = sourceElevation;
+		return;
+	}
+
+	SpatialMath::Vector3 relative = SpatialMath::rotateToListener(
+		SpatialMath::directionToVector(sourceAzimuth, sourceElevation),
+		listenerOrientation.yaw,
+		listenerOrientation.pitch,
+		listenerOrientation.roll
+	);
+
+	SpatialMath::vectorToDirection(relative, convoluter->azimuth, convoluter->elevation);
+}
+
+double SoundStageAudioProcessor::getHeadTrackingLatencyMs() const {
+	return headTrackingLatencyMs;
+}
+
 
 
 
@@ -15,6 +15,10 @@
 #include <math.h>
 #include <cmath>
 #include "Convoluter.h"
+#include "HeadTracker.h"
+#include "SpatialMath.h"
+#include "DistanceModel.h"
+#include "TrajectoryEngine.h"
 
 //==============================================================================
 /**
@@ -62,10 +66,23 @@ public:
 
 	void process(juce::dsp::ProcessContextReplacing<float> context);
 	void updateParameters();
+	//packet arrival to output, the audio device's own buffering comes on top
+	double getHeadTrackingLatencyMs() const;
+	void setTrajectory(const TrajectoryEngine::Trajectory& trajectory);
+	//message thread only, opens or closes the shared OSC socket
+	void setHeadTracking(bool enabled, int port);
 
 	//real params
 	float elevation;
 	float azimuth;
+	float roomLevel;
+	float distance;
+	bool headTrackingEnabled;
+	int headTrackingPort;
+	bool lowPriority;
+	//blocks peaking under this run the short HRIR, 0 leaves the level of detail to lowPriority
+	float lodThreshold;
+	Convoluter::HrirStorage hrirStorage;
 	Convoluter* convoluter;
 
 
@@ -78,6 +95,21 @@ private:
 	//==============================================================================
 	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SoundStageAudioProcessor)
 
+		//direction is re-evaluated this often inside each host block
+		static constexpr int subBlockSize = 32;
+		//an orientation this old is dropped, so a sender that stops does not leave the mix turned
+		static constexpr double orientationTimeoutSeconds = 1.0;
+
+		juce::SharedResourcePointer<HeadTracker> headTracker;
+		HeadTracker::Orientation listenerOrientation;
+		uint32_t lastOrientationSequence;
+		std::atomic<double> headTrackingLatencyMs;
+		juce::AudioBuffer<float> inputCopy;
+		DistanceModel distanceModel;
+		TrajectoryEngine trajectory;
+
+		void updateDirection(int sampleOffset);
+
 		void applyHRTF(float* channelData, float* hrtf, int numSamples);
 		float correctAzimuth(float azimuth);
 		float correctElevation(float elevation, float azimuth);
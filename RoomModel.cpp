@@ -0,0 +1,479 @@
+/*
+  ==============================================================================
+
+    RoomModel.cpp
+
+  ==============================================================================
+*/
+
+#include "RoomModel.h"
+#include "Convoluter.h"
+
+RoomModel::RoomModel() {
+	//off until asked for, so the anechoic direct path sounds the way it always has
+	enabled = false;
+	level = 0.0f;
+	running = false;
+	lateLevel = 0.0f;
+
+	sampleRate = 44100.0;
+	historyLength = 0;
+	maxBlockSize = 0;
+	maxDelay = 0;
+	preDelay = 0;
+	tailLength = 0;
+
+	roomWidth = 6.0f;
+	roomDepth = 5.0f;
+	roomHeight = 3.0f;
+	absorption = 0.3f;
+	sourceDistance = 1.0f;
+	lastAzimuth = 0.0f;
+	lastElevation = 0.0f;
+	geometryDirty = true;
+
+	//every image source up to second order excluding the direct path, first order images first
+	int r = 0;
+	for (int wanted = 1; wanted <= 2; wanted++) {
+		for (int nx = -2; nx <= 2; nx++) {
+			for (int ny = -2; ny <= 2; ny++) {
+				for (int nz = -2; nz <= 2; nz++) {
+					if (abs(nx) + abs(ny) + abs(nz) != wanted)
+						continue;
+
+					order[r][0] = nx;
+					order[r][1] = ny;
+					order[r][2] = nz;
+					r++;
+				}
+			}
+		}
+
+		jassert(wanted != 1 || r == numFirstOrder);
+	}
+	jassert(r == numReflections);
+
+	clearReflections();
+
+	for (int i = 0; i < numLateLines; i++) {
+		lateLength[i] = 1;
+		latePos[i] = 0;
+		lateGain[i] = 0.0f;
+		lateDamping[i] = 0.0f;
+	}
+	dampingCoefficient = 0.0f;
+}
+
+RoomModel::~RoomModel() {
+
+}
+
+void RoomModel::prepare(double newSampleRate, int maximumBlockSize) {
+	sampleRate = newSampleRate;
+	maxBlockSize = maximumBlockSize;
+	maxDelay = (int)(maxDelaySeconds * sampleRate);
+
+	//enough history for the longest reflection plus the latest HRIR onset
+	historyLength = maxDelay + 200;
+	history.assign(historyLength + maxBlockSize, 0.0f);
+	earlyOutput[0].assign(maxBlockSize + reflectionHrirLength, 0.0f);
+	earlyOutput[1].assign(maxBlockSize + reflectionHrirLength, 0.0f);
+
+	for (int i = 0; i < numLateLines; i++) {
+		lateLines[i].assign((size_t)(0.1 * sampleRate), 0.0f);
+		latePos[i] = 0;
+		lateDamping[i] = 0.0f;
+	}
+
+	clearReflections();
+	updateLateReverb();
+	geometryDirty = true;
+	running = false;
+	lateLevel = 0.0f;
+}
+
+void RoomModel::clear() {
+	//forget everything the room heard before, so nothing old plays back when it comes on again
+	std::fill(history.begin(), history.end(), 0.0f);
+	std::fill(earlyOutput[0].begin(), earlyOutput[0].end(), 0.0f);
+	std::fill(earlyOutput[1].begin(), earlyOutput[1].end(), 0.0f);
+
+	for (int i = 0; i < numLateLines; i++) {
+		std::fill(lateLines[i].begin(), lateLines[i].end(), 0.0f);
+		latePos[i] = 0;
+		lateDamping[i] = 0.0f;
+	}
+
+	clearReflections();
+	lateLevel = 0.0f;
+	geometryDirty = true;
+}
+
+bool RoomModel::isRunning() const {
+	return enabled || running;
+}
+
+void RoomModel::clearReflections() {
+	//nothing to fade from, the next direction fades each reflection in from silence
+	for (int r = 0; r < numFirstOrder; r++) {
+		for (int state = 0; state < 2; state++) {
+			early[r][state].azIndex = -1;
+			early[r][state].elIndex = -1;
+			early[r][state].delay = 0;
+			early[r][state].onsetL = 0;
+			early[r][state].onsetR = 0;
+			early[r][state].gain = 0.0f;
+		}
+
+		earlyCurrent[r] = 0;
+		earlyFading[r] = false;
+		earlyGain[r] = 0.0f;
+	}
+
+	for (int t = 0; t < numSecondOrder; t++) {
+		for (int state = 0; state < 2; state++)
+			taps[t][state] = { 0, 0, 0.0f, 0.0f };
+
+		tapCurrent[t] = 0;
+		tapFading[t] = false;
+	}
+
+	tapLevel = 0.0f;
+}
+
+void RoomModel::setRoomSize(float width, float depth, float height) {
+	roomWidth = juce::jmax(1.0f, width);
+	roomDepth = juce::jmax(1.0f, depth);
+	roomHeight = juce::jmax(1.0f, height);
+
+	updateLateReverb();
+	geometryDirty = true;
+}
+
+void RoomModel::setAbsorption(float newAbsorption) {
+	absorption = juce::jlimit(0.01f, 1.0f, newAbsorption);
+
+	updateLateReverb();
+	geometryDirty = true;
+}
+
+void RoomModel::setSourceDistance(float distance) {
+	if (distance != sourceDistance) {
+		sourceDistance = distance;
+		geometryDirty = true;
+	}
+}
+
+void RoomModel::updateLateReverb() {
+	static const float spread[numLateLines] = { 1.0f, 1.13f, 1.27f, 1.41f, 1.59f, 1.73f, 1.89f, 2.03f };
+
+	float volume = roomWidth * roomDepth * roomHeight;
+	float surface = 2.0f * (roomWidth * roomDepth + roomWidth * roomHeight + roomDepth * roomHeight);
+
+	//Sabine's formula, and the mean free path sets the spacing of the delay lines
+	float rt60 = 0.161f * volume / (surface * absorption);
+	float meanFreePath = 4.0f * volume / surface;
+	float meanFreePathSamples = meanFreePath / speedOfSound * (float)sampleRate;
+
+	for (int i = 0; i < numLateLines; i++) {
+		int capacity = (int)lateLines[i].size();
+
+		if (capacity == 0) {
+			lateLength[i] = 1;
+			continue;
+		}
+
+		lateLength[i] = juce::jlimit(1, capacity, (int)(meanFreePathSamples * spread[i]));
+		if (latePos[i] >= lateLength[i])
+			latePos[i] = 0;
+
+		lateGain[i] = std::pow(10.0f, -3.0f * lateLength[i] / ((float)sampleRate * rt60));
+	}
+
+	dampingCoefficient = 0.2f + 0.5f * absorption;
+	preDelay = juce::jlimit(0, maxDelay, (int)meanFreePathSamples);
+
+	//long enough for the reflections to pass and the tail to fall about 120 dB
+	tailLength = historyLength + (int)(2.0f * rt60 * (float)sampleRate);
+}
+
+int RoomModel::getTailLength() const {
+	return tailLength;
+}
+
+float RoomModel::imageCoordinate(int n, float size, float source) {
+	//odd orders mirror the source in the far wall, even orders are a plain translation
+	if (n % 2 != 0)
+		return n * size + (size - source);
+
+	return n * size + source;
+}
+
+int RoomModel::window_hrir(const float* hrir, float* dest) {
+	float peak = 0.0f;
+	for (int k = 0; k < 200; k++)
+		peak = juce::jmax(peak, std::abs(hrir[k]));
+
+	int onset = 0;
+	while (onset < 200 && std::abs(hrir[onset]) < 0.1f * peak)
+		onset++;
+
+	int start = juce::jlimit(0, 200 - reflectionHrirLength, onset - 2);
+
+	for (int k = 0; k < reflectionHrirLength; k++)
+		dest[k] = hrir[start + k];
+
+	//fade out the last few taps so the truncation does not ring
+	const int fadeLength = 8;
+	for (int k = 0; k < fadeLength; k++) {
+		float fade = 0.5f + 0.5f * std::cos(juce::MathConstants<float>::pi * (k + 1) / (fadeLength + 1));
+		dest[reflectionHrirLength - fadeLength + k] *= fade;
+	}
+
+	return start;
+}
+
+void RoomModel::setSourceDirection(float azimuth, float elevation, Convoluter& hrtf) {
+	if (!geometryDirty && azimuth == lastAzimuth && elevation == lastElevation)
+		return;
+
+	lastAzimuth = azimuth;
+	lastElevation = elevation;
+	geometryDirty = false;
+
+	SpatialMath::Vector3 direction = SpatialMath::directionToVector(azimuth, elevation);
+	SpatialMath::Vector3 listener = { roomWidth * 0.5f, roomDepth * 0.5f, juce::jmin(1.2f, roomHeight * 0.5f) };
+	SpatialMath::Vector3 source = {
+		juce::jlimit(0.1f, roomWidth - 0.1f, listener.x + sourceDistance * direction.x),
+		juce::jlimit(0.1f, roomDepth - 0.1f, listener.y + sourceDistance * direction.y),
+		juce::jlimit(0.1f, roomHeight - 0.1f, listener.z + sourceDistance * direction.z)
+	};
+	SpatialMath::Vector3 directPath = { source.x - listener.x, source.y - listener.y, source.z - listener.z };
+	float directDistance = juce::jmax(0.1f, SpatialMath::length(directPath));
+	float reflectionCoefficient = std::sqrt(1.0f - absorption);
+
+	/*
+	* the geometry is cheap so every image is moved. A reflection whose delay or
+	* HRIR changed swaps to its spare state and crossfades, a gain change alone is ramped
+	*/
+	for (int r = 0; r < numReflections; r++) {
+		SpatialMath::Vector3 image = {
+			imageCoordinate(order[r][0], roomWidth, source.x),
+			imageCoordinate(order[r][1], roomDepth, source.y),
+			imageCoordinate(order[r][2], roomHeight, source.z)
+		};
+		SpatialMath::Vector3 path = { image.x - listener.x, image.y - listener.y, image.z - listener.z };
+		float distance = juce::jmax(directDistance, SpatialMath::length(path));
+		int bounces = abs(order[r][0]) + abs(order[r][1]) + abs(order[r][2]);
+
+		float gain = std::pow(reflectionCoefficient, (float)bounces) * directDistance / distance;
+		int delay = juce::jlimit(0, maxDelay,
+			juce::roundToInt((distance - directDistance) / speedOfSound * (float)sampleRate));
+
+		if (r < numFirstOrder) {
+			float reflectionAzimuth, reflectionElevation;
+			SpatialMath::vectorToDirection(path, reflectionAzimuth, reflectionElevation);
+
+			int azIndex, elIndex;
+			hrtf.closest_hrir_indices(reflectionAzimuth, reflectionElevation, azIndex, elIndex);
+
+			Early& from = early[r][earlyCurrent[r]];
+
+			if (azIndex == from.azIndex && elIndex == from.elIndex && delay == from.delay) {
+				from.gain = gain;
+				continue;
+			}
+
+			Early& to = early[r][1 - earlyCurrent[r]];
+
+			if (azIndex != from.azIndex || elIndex != from.elIndex) {
+				to.onsetL = window_hrir(hrtf.get_hrir_l(azIndex, elIndex), to.hrirL);
+				to.onsetR = window_hrir(hrtf.get_hrir_r(azIndex, elIndex), to.hrirR);
+			}
+			else {
+				to.onsetL = from.onsetL;
+				to.onsetR = from.onsetR;
+				std::memcpy(to.hrirL, from.hrirL, sizeof(to.hrirL));
+				std::memcpy(to.hrirR, from.hrirR, sizeof(to.hrirR));
+			}
+
+			to.azIndex = azIndex;
+			to.elIndex = elIndex;
+			to.delay = delay;
+			to.gain = gain;
+			earlyCurrent[r] = 1 - earlyCurrent[r];
+			earlyFading[r] = true;
+			continue;
+		}
+
+		/*
+		* Woodworth's spherical head gives the far ear's extra delay,
+		* and the far ear loses up to 6 dB in the head's shadow
+		*/
+		float lateral = juce::jlimit(-1.0f, 1.0f, path.x / juce::jmax(1.0e-6f, SpatialMath::length(path)));
+		float angle = std::asin(std::abs(lateral));
+		int itd = juce::roundToInt(headRadius / speedOfSound * (angle + std::sin(angle)) * (float)sampleRate);
+		float shadow = 1.0f - 0.5f * std::abs(lateral);
+
+		Tap next;
+		next.delayL = juce::jmin(historyLength, delay + (lateral > 0.0f ? itd : 0));
+		next.delayR = juce::jmin(historyLength, delay + (lateral < 0.0f ? itd : 0));
+		next.gainL = lateral > 0.0f ? gain * shadow : gain;
+		next.gainR = lateral < 0.0f ? gain * shadow : gain;
+
+		int t = r - numFirstOrder;
+		const Tap& from = taps[t][tapCurrent[t]];
+
+		if (next.delayL == from.delayL && next.delayR == from.delayR && next.gainL == from.gainL && next.gainR == from.gainR)
+			continue;
+
+		tapCurrent[t] = 1 - tapCurrent[t];
+		taps[t][tapCurrent[t]] = next;
+		tapFading[t] = true;
+	}
+}
+
+void RoomModel::renderEarly(const Early& reflection, const float* hist, int numSamples, float gainStart, float gainEnd) {
+	float gainStep = (gainEnd - gainStart) / numSamples;
+
+	//scatter each input sample's response, one ear at a time like the direct path loop
+	for (int ear = 0; ear < 2; ear++) {
+		const float* read = hist + historyLength - reflection.delay - (ear == 0 ? reflection.onsetL : reflection.onsetR);
+		const float* hrir = ear == 0 ? reflection.hrirL : reflection.hrirR;
+		float* out = earlyOutput[ear].data();
+		float gain = gainStart;
+
+		for (int i = 0; i < numSamples; i++) {
+			gain += gainStep;
+			float sample = gain * read[i];
+
+			for (int k = 0; k < reflectionHrirLength; k++) {
+				out[i + k] += sample * hrir[k];
+			}
+		}
+	}
+}
+
+void RoomModel::renderTap(const Tap& tap, const float* hist, float* left, float* right, int numSamples, float scaleStart, float scaleEnd) {
+	const float* readL = hist + historyLength - tap.delayL;
+	const float* readR = hist + historyLength - tap.delayR;
+	float scale = scaleStart;
+	float scaleStep = (scaleEnd - scaleStart) / numSamples;
+
+	for (int i = 0; i < numSamples; i++) {
+		scale += scaleStep;
+		left[i] += scale * tap.gainL * readL[i];
+		right[i] += scale * tap.gainR * readR[i];
+	}
+}
+
+void RoomModel::process(const float* input, float* left, float* right, int numSamples) {
+	jassert(numSamples <= maxBlockSize);
+
+	if (history.empty() || numSamples <= 0)
+		return;
+
+	if (enabled && !running)
+		clear();
+
+	//fades to silence over this block when switched off
+	float targetLevel = enabled ? level : 0.0f;
+	float* hist = history.data();
+	juce::FloatVectorOperations::copy(hist + historyLength, input, numSamples);
+
+	//first order reflections, crossfading from the previous HRIR and delay when they moved
+	for (int r = 0; r < numFirstOrder; r++) {
+		const Early& current = early[r][earlyCurrent[r]];
+		const Early& previous = early[r][1 - earlyCurrent[r]];
+		float target = current.gain * targetLevel;
+
+		if (earlyFading[r]) {
+			if (previous.azIndex >= 0)
+				renderEarly(previous, hist, numSamples, earlyGain[r], 0.0f);
+
+			renderEarly(current, hist, numSamples, 0.0f, target);
+			earlyFading[r] = false;
+		}
+		else if (current.azIndex >= 0) {
+			renderEarly(current, hist, numSamples, earlyGain[r], target);
+		}
+
+		earlyGain[r] = target;
+	}
+
+	//hand over this block, the responses running past its end carry into the next one
+	for (int ear = 0; ear < 2; ear++) {
+		float* out = earlyOutput[ear].data();
+
+		juce::FloatVectorOperations::add(ear == 0 ? left : right, out, numSamples);
+		std::memmove(out, out + numSamples, sizeof(float) * reflectionHrirLength);
+		juce::FloatVectorOperations::clear(out + reflectionHrirLength, numSamples);
+	}
+
+	//second order reflections, a tap per ear
+	for (int t = 0; t < numSecondOrder; t++) {
+		const Tap& current = taps[t][tapCurrent[t]];
+
+		if (tapFading[t]) {
+			renderTap(taps[t][1 - tapCurrent[t]], hist, left, right, numSamples, tapLevel, 0.0f);
+			renderTap(current, hist, left, right, numSamples, 0.0f, targetLevel);
+			tapFading[t] = false;
+		}
+		else {
+			renderTap(current, hist, left, right, numSamples, tapLevel, targetLevel);
+		}
+	}
+
+	tapLevel = targetLevel;
+
+	/*
+	* late reverb: 8 delay lines with one pole damping, mixed through a
+	* normalised Hadamard matrix. Even lines feed the left ear, odd lines the right
+	*/
+	const float* lateInput = hist + historyLength - preDelay;
+	//the input already carries the 1/distance law, the diffuse tail should not
+	const float inputGain = 0.25f * (1.0f - absorption) * sourceDistance;
+	float outputGain = 0.5f * lateLevel;
+	const float outputStep = 0.5f * (targetLevel - lateLevel) / numSamples;
+	const float hadamardScale = 0.35355339f;
+
+	for (int i = 0; i < numSamples; i++) {
+		float x[numLateLines];
+
+		for (int l = 0; l < numLateLines; l++)
+			x[l] = lateLines[l][latePos[l]];
+
+		outputGain += outputStep;
+		left[i] += outputGain * (x[0] + x[2] + x[4] + x[6]);
+		right[i] += outputGain * (x[1] + x[3] + x[5] + x[7]);
+
+		for (int l = 0; l < numLateLines; l++) {
+			lateDamping[l] = (1.0f - dampingCoefficient) * x[l] + dampingCoefficient * lateDamping[l];
+			x[l] = lateDamping[l] * lateGain[l];
+		}
+
+		for (int span = 1; span < numLateLines; span *= 2) {
+			for (int l = 0; l < numLateLines; l += 2 * span) {
+				for (int m = l; m < l + span; m++) {
+					float a = x[m];
+					float b = x[m + span];
+					x[m] = a + b;
+					x[m + span] = a - b;
+				}
+			}
+		}
+
+		float in = lateInput[i] * inputGain;
+		for (int l = 0; l < numLateLines; l++) {
+			lateLines[l][latePos[l]] = x[l] * hadamardScale + ((l & 1) ? -in : in);
+
+			if (++latePos[l] >= lateLength[l])
+				latePos[l] = 0;
+		}
+	}
+
+	std::memmove(hist, hist + numSamples, sizeof(float) * historyLength);
+
+	lateLevel = targetLevel;
+	running = enabled;
+}
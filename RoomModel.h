@@ -0,0 +1,118 @@
+/*
+  ==============================================================================
+
+    RoomModel.h
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <vector>
+#include "SpatialMath.h"
+
+class Convoluter;
+
+/*
+* Cheap room stage that runs next to the direct HRTF path.
+* Early reflections come from a shoebox image source model (up to second order).
+* The six first order images are rendered through a short window of the nearest
+* HRIR in the grid, the second order images only get a delay, a gain and an ITD.
+* Whenever the source moves, each reflection that changed crossfades from its old
+* state to the new one over the next block. The late tail is a single 8 line
+* feedback delay network shared by everything the instance renders.
+*/
+class RoomModel {
+    public:
+        RoomModel();
+        ~RoomModel();
+        void prepare(double sampleRate, int maximumBlockSize);
+        void setRoomSize(float width, float depth, float height);
+        void setAbsorption(float absorption);
+        void setSourceDistance(float distance);
+        void setSourceDirection(float azimuth, float elevation, Convoluter& hrtf);
+        void process(const float* input, float* left, float* right, int numSamples);
+        void clear();
+        bool isRunning() const;
+        int getTailLength() const;
+        //switching off fades the room out over one block before it stops, switching on starts it from silence
+        bool enabled;
+        float level;
+    private:
+        static constexpr int numReflections = 24;
+        static constexpr int numFirstOrder = 6;
+        static constexpr int numSecondOrder = numReflections - numFirstOrder;
+        static constexpr int reflectionHrirLength = 32;
+        static constexpr int numLateLines = 8;
+        static constexpr float speedOfSound = 343.0f;
+        static constexpr float maxDelaySeconds = 0.25f;
+        static constexpr float headRadius = 0.0875f;
+
+        //first order image, a delayed and scaled short HRIR pair
+        struct Early {
+            int azIndex;
+            int elIndex;
+            int delay;
+            int onsetL;
+            int onsetR;
+            float gain;
+            float hrirL[reflectionHrirLength];
+            float hrirR[reflectionHrirLength];
+        };
+
+        //second order image, one delayed and scaled tap per ear
+        struct Tap {
+            int delayL;
+            int delayR;
+            float gainL;
+            float gainR;
+        };
+
+        //the image orders, first order images come first
+        int order[numReflections][3];
+
+        //two states per reflection, the current one and the one it is fading from
+        Early early[numFirstOrder][2];
+        int earlyCurrent[numFirstOrder];
+        bool earlyFading[numFirstOrder];
+        float earlyGain[numFirstOrder];
+        Tap taps[numSecondOrder][2];
+        int tapCurrent[numSecondOrder];
+        bool tapFading[numSecondOrder];
+        float tapLevel;
+        float lateLevel;
+        bool running;
+
+        std::vector<float> history;
+        std::vector<float> earlyOutput[2];
+        int historyLength;
+        int maxBlockSize;
+        int maxDelay;
+
+        std::vector<float> lateLines[numLateLines];
+        int lateLength[numLateLines];
+        int latePos[numLateLines];
+        float lateGain[numLateLines];
+        float lateDamping[numLateLines];
+        float dampingCoefficient;
+        int preDelay;
+        int tailLength;
+
+        double sampleRate;
+        float roomWidth;
+        float roomDepth;
+        float roomHeight;
+        float absorption;
+        float sourceDistance;
+        float lastAzimuth;
+        float lastElevation;
+        bool geometryDirty;
+
+        void updateLateReverb();
+        void clearReflections();
+        void renderEarly(const Early& reflection, const float* hist, int numSamples, float gainStart, float gainEnd);
+        void renderTap(const Tap& tap, const float* hist, float* left, float* right, int numSamples, float scaleStart, float scaleEnd);
+        int window_hrir(const float* hrir, float* dest);
+        float imageCoordinate(int n, float size, float source);
+};
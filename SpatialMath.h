@@ -0,0 +1,66 @@
+/*
+  ==============================================================================
+
+    SpatialMath.h
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <cmath>
+
+/*
+* Conversions between the plugin's direction convention and listener relative
+* vectors. Azimuth runs 0-360 clockwise from the front (90 is the right ear),
+* elevation runs -90 to 90 with 90 straight up.
+* x points to the right, y points forward and z points up.
+*/
+namespace SpatialMath {
+
+    struct Vector3 {
+        float x;
+        float y;
+        float z;
+    };
+
+    constexpr float degreesToRadians = 3.14159265358979f / 180.0f;
+    constexpr float radiansToDegrees = 180.0f / 3.14159265358979f;
+
+    inline Vector3 directionToVector(float azimuth, float elevation) {
+        float az = azimuth * degreesToRadians;
+        float el = elevation * degreesToRadians;
+
+        return { std::cos(el) * std::sin(az), std::cos(el) * std::cos(az), std::sin(el) };
+    }
+
+    inline void vectorToDirection(const Vector3& v, float& azimuth, float& elevation) {
+        float horizontal = std::sqrt(v.x * v.x + v.y * v.y);
+
+        azimuth = std::atan2(v.x, v.y) * radiansToDegrees;
+        if (azimuth < 0.0f)
+            azimuth += 360.0f;
+
+        elevation = std::atan2(v.z, horizontal) * radiansToDegrees;
+    }
+
+    inline float length(const Vector3& v) {
+        return std::sqrt(v.x * v.x + v.y * v.y + v.z * v.z);
+    }
+
+    /*
+    * Takes a world direction into the listener's frame. Yaw turns right,
+    * pitch looks up and roll drops the right ear, all in degrees, undone in
+    * yaw, pitch, roll order.
+    */
+    inline Vector3 rotateToListener(const Vector3& v, float yaw, float pitch, float roll) {
+        float cy = std::cos(yaw * degreesToRadians), sy = std::sin(yaw * degreesToRadians);
+        float cp = std::cos(pitch * degreesToRadians), sp = std::sin(pitch * degreesToRadians);
+        float cr = std::cos(roll * degreesToRadians), sr = std::sin(roll * degreesToRadians);
+
+        Vector3 a = { v.x * cy - v.y * sy, v.y * cy + v.x * sy, v.z };
+        Vector3 b = { a.x, a.y * cp + a.z * sp, a.z * cp - a.y * sp };
+
+        return { b.x * cr - b.z * sr, b.y, b.z * cr + b.x * sr };
+    }
+}
@@ -0,0 +1,28 @@
+/*
+  ==============================================================================
+
+    SoundStageTests.cpp
+
+  ==============================================================================
+*/
+
+/*
+* Console entry point for the engine's unit tests. Build it as its own console
+* target with SOUNDSTAGE_RUN_TESTS=1, together with EngineValidator.cpp,
+* Convoluter.cpp and RoomModel.cpp, and with the SoundStage data folder
+* installed. The plugin never defines SOUNDSTAGE_RUN_TESTS, so it registers
+* no tests. The exit code is 1 if any check failed, so CI can gate on it.
+*/
+
+#include <JuceHeader.h>
+
+int main() {
+	juce::UnitTestRunner runner;
+	runner.runTestsInCategory("SoundStage");
+
+	int failures = 0;
+	for (int i = 0; i < runner.getNumResults(); i++)
+		failures += runner.getResult(i)->failures;
+
+	return failures > 0 ? 1 : 0;
+}
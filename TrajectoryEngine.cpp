@@ -0,0 +1,208 @@
+/*
+  ==============================================================================
+
+    TrajectoryEngine.cpp
+
+  ==============================================================================
+*/
+
+#include "TrajectoryEngine.h"
+
+TrajectoryEngine::TrajectoryEngine() {
+	lastSeen = 0;
+	current = orbit(0.0f, 0.0f, 0.0f);
+	current.mode = Mode::off;
+
+	sampleRate = 44100.0;
+	samplesSinceSet = 0;
+	transportAvailable = false;
+	transportPlaying = false;
+	transportBeats = 0.0;
+	transportSeconds = 0.0;
+	beatsPerSecond = 2.0;
+}
+
+TrajectoryEngine::~TrajectoryEngine() {
+
+}
+
+void TrajectoryEngine::prepare(double newSampleRate) {
+	sampleRate = newSampleRate;
+	samplesSinceSet = 0;
+}
+
+TrajectoryEngine::Trajectory TrajectoryEngine::orbit(float rate, float startAzimuth, float elevation) {
+	Trajectory trajectory = {};
+
+	trajectory.mode = Mode::orbit;
+	trajectory.orbitRate = rate;
+	trajectory.orbitStart = startAzimuth;
+	trajectory.orbitElevation = elevation;
+	trajectory.syncToHost = true;
+	trajectory.keepPhase = true;
+	trajectory.numPoints = 0;
+
+	return trajectory;
+}
+
+void TrajectoryEngine::setTrajectory(const Trajectory& trajectory) {
+	//message thread only, sort here so the audio thread can walk the points in order
+	Trajectory sorted = trajectory;
+
+	sorted.numPoints = juce::jlimit(0, maxPoints, sorted.numPoints);
+	std::sort(sorted.points, sorted.points + sorted.numPoints,
+		[](const Point& a, const Point& b) { return a.time < b.time; });
+
+	pending.write(sorted);
+}
+
+void TrajectoryEngine::beginBlock(bool hasTransport, bool isPlaying, double ppqPosition, double bpm, double timeInSeconds) {
+	transportAvailable = hasTransport;
+	transportPlaying = hasTransport && isPlaying;
+	transportBeats = ppqPosition;
+	transportSeconds = timeInSeconds;
+	beatsPerSecond = bpm > 0.0 ? bpm / 60.0 : 2.0;
+
+	Trajectory next;
+	if (!pending.read(next, lastSeen))
+		return;
+
+	//where a running orbit has got to, before its clock is replaced
+	float azimuth = 0.0f, elevation = 0.0f;
+	bool wasOrbiting = current.mode == Mode::orbit && evaluate(0, azimuth, elevation);
+
+	//a new trajectory restarts the internal clock
+	samplesSinceSet = 0;
+
+	//orbitStart is where the orbit is at time 0, so it is moved back to line the anchor up with now
+	if (next.mode == Mode::orbit) {
+		double anchor = next.keepPhase && wasOrbiting ? azimuth : next.orbitStart;
+		double start = std::fmod(anchor - next.orbitRate * clockSeconds(next, 0), 360.0);
+
+		next.orbitStart = (float)(start < 0.0 ? start + 360.0 : start);
+	}
+
+	current = next;
+}
+
+void TrajectoryEngine::endBlock(int numSamples) {
+	samplesSinceSet += numSamples;
+}
+
+bool TrajectoryEngine::evaluate(int sampleOffset, float& azimuth, float& elevation) {
+	if (current.mode == Mode::off)
+		return false;
+
+	double offsetSeconds = sampleOffset / sampleRate;
+	double seconds = clockSeconds(current, sampleOffset);
+
+	if (current.mode == Mode::orbit) {
+		azimuth = (float)std::fmod(current.orbitStart + current.orbitRate * seconds, 360.0);
+		if (azimuth < 0.0f)
+			azimuth += 360.0f;
+
+		elevation = current.orbitElevation;
+		return true;
+	}
+
+	if (current.mode == Mode::path)
+		return evaluateSpline(seconds, true, azimuth, elevation);
+
+	//keyframes follow the host timeline and hold still while it is stopped
+	double beats = transportPlaying ? transportBeats + offsetSeconds * beatsPerSecond : transportBeats;
+	return evaluateSpline(beats, false, azimuth, elevation);
+}
+
+double TrajectoryEngine::clockSeconds(const Trajectory& trajectory, int sampleOffset) const {
+	double offsetSeconds = sampleOffset / sampleRate;
+
+	if (!trajectory.syncToHost || !transportAvailable)
+		return samplesSinceSet / sampleRate + offsetSeconds;
+
+	return transportPlaying ? transportSeconds + offsetSeconds : transportSeconds;
+}
+
+SpatialMath::Vector3 TrajectoryEngine::pointVector(int index, bool loop) {
+	int n = current.numPoints;
+
+	if (loop)
+		index = ((index % n) + n) % n;
+	else
+		index = juce::jlimit(0, n - 1, index);
+
+	return SpatialMath::directionToVector(current.points[index].azimuth, current.points[index].elevation);
+}
+
+double TrajectoryEngine::pointTime(int index, bool loop, double period) {
+	int n = current.numPoints;
+
+	if (!loop)
+		return current.points[juce::jlimit(0, n - 1, index)].time;
+
+	//indices past the end come round again one period later
+	int wraps = index >= 0 ? index / n : -((n - 1 - index) / n);
+	return current.points[index - wraps * n].time + wraps * period;
+}
+
+bool TrajectoryEngine::evaluateSpline(double time, bool loop, float& azimuth, float& elevation) {
+	int n = current.numPoints;
+
+	if (n == 0)
+		return false;
+
+	double first = current.points[0].time;
+	double last = current.points[n - 1].time;
+	double period = current.pathDuration > 0.0f ? current.pathDuration : last - first;
+
+	if (n == 1 || (loop && period <= 0.0)) {
+		azimuth = current.points[0].azimuth;
+		elevation = current.points[0].elevation;
+		return true;
+	}
+
+	if (loop) {
+		time = first + std::fmod(time - first, period);
+		if (time < first)
+			time += period;
+	}
+	else {
+		time = juce::jlimit(first, last, time);
+	}
+
+	//find the segment, wrapping from the last point back to the first when looping
+	int segment = 0;
+	while (segment < n - 1 && time >= pointTime(segment + 1, loop, period))
+		segment++;
+
+	double start = pointTime(segment, loop, period);
+	double end = pointTime(segment + 1, loop, period);
+	float u = end > start ? (float)((time - start) / (end - start)) : 0.0f;
+
+	/*
+	* Catmull-Rom on unit vectors rather than on the angles,
+	* so paths can cross 0/360 azimuth or pass overhead without a jump
+	*/
+	SpatialMath::Vector3 p0 = pointVector(segment - 1, loop);
+	SpatialMath::Vector3 p1 = pointVector(segment, loop);
+	SpatialMath::Vector3 p2 = pointVector(segment + 1, loop);
+	SpatialMath::Vector3 p3 = pointVector(segment + 2, loop);
+
+	float u2 = u * u;
+	float u3 = u2 * u;
+	float w0 = -0.5f * u3 + u2 - 0.5f * u;
+	float w1 = 1.5f * u3 - 2.5f * u2 + 1.0f;
+	float w2 = -1.5f * u3 + 2.0f * u2 + 0.5f * u;
+	float w3 = 0.5f * u3 - 0.5f * u2;
+
+	SpatialMath::Vector3 v = {
+		w0 * p0.x + w1 * p1.x + w2 * p2.x + w3 * p3.x,
+		w0 * p0.y + w1 * p1.y + w2 * p2.y + w3 * p3.y,
+		w0 * p0.z + w1 * p1.z + w2 * p2.z + w3 * p3.z
+	};
+
+	if (SpatialMath::length(v) < 1.0e-6f)
+		v = p1;
+
+	SpatialMath::vectorToDirection(v, azimuth, elevation);
+	return true;
+}
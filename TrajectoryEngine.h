@@ -0,0 +1,87 @@
+/*
+  ==============================================================================
+
+    TrajectoryEngine.h
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "LatestValue.h"
+#include "SpatialMath.h"
+
+/*
+* Source motion evaluated on the audio thread once per sub-block.
+* A trajectory is a plain fixed size struct, handed over from the message thread
+* through a LatestValue slot, so nothing allocates or locks after it is set.
+* Time comes from counted samples or the host transport, never the wall clock,
+* so offline bounces render the same motion every time. Synced trajectories
+* follow the transport position and hold still while it is stopped, they only
+* fall back to counted samples when there is no host transport at all.
+*
+*   orbit      circles at orbitRate degrees per second, at orbitElevation, passing
+*              orbitStart at time 0. With keepPhase a new orbit that replaces a
+*              running one carries on from where the source is, otherwise it
+*              starts from orbitStart at the moment it is set
+*   path       closed Catmull-Rom spline through the points, point times in seconds,
+*              looping every pathDuration seconds
+*   keyframes  open Catmull-Rom spline, point times in beats on the host timeline
+*/
+class TrajectoryEngine {
+    public:
+        enum class Mode {
+            off,
+            orbit,
+            path,
+            keyframes
+        };
+
+        static constexpr int maxPoints = 32;
+
+        struct Point {
+            float time;
+            float azimuth;
+            float elevation;
+        };
+
+        struct Trajectory {
+            Mode mode;
+            float orbitRate;
+            float orbitStart;
+            float orbitElevation;
+            float pathDuration;
+            bool syncToHost;
+            bool keepPhase;
+            int numPoints;
+            Point points[maxPoints];
+        };
+
+        TrajectoryEngine();
+        ~TrajectoryEngine();
+        void prepare(double sampleRate);
+        void setTrajectory(const Trajectory& trajectory);
+        void beginBlock(bool hasTransport, bool isPlaying, double ppqPosition, double bpm, double timeInSeconds);
+        bool evaluate(int sampleOffset, float& azimuth, float& elevation);
+        void endBlock(int numSamples);
+
+        static Trajectory orbit(float rate, float startAzimuth, float elevation);
+    private:
+        LatestValue<Trajectory> pending;
+        uint32_t lastSeen;
+        Trajectory current;
+
+        double sampleRate;
+        juce::int64 samplesSinceSet;
+        bool transportAvailable;
+        bool transportPlaying;
+        double transportBeats;
+        double transportSeconds;
+        double beatsPerSecond;
+
+        double clockSeconds(const Trajectory& trajectory, int sampleOffset) const;
+        bool evaluateSpline(double time, bool loop, float& azimuth, float& elevation);
+        SpatialMath::Vector3 pointVector(int index, bool loop);
+        double pointTime(int index, bool loop, double period);
+};